@@ -0,0 +1,77 @@
+
+#include "bench.h"
+
+constexpr u64 N = 10000;
+
+struct Node {
+    u64 value = 0;
+    Node* next = null;
+};
+
+void bench_allocators(Bench& bench) noexcept {
+    bench.suite = "allocators"_v;
+
+    bench.run("Mdefault::alloc/free 64"_v, N, [] {
+        for(u64 i = 0; i < N; i++) {
+            void* ptr = Mdefault::alloc(64);
+            keep(reinterpret_cast<uptr>(ptr));
+            Mdefault::free(ptr);
+        }
+    });
+    bench.run("Mdefault::alloc batch 64"_v, N, [] {
+        Vec<void*> ptrs;
+        ptrs.reserve(N);
+        for(u64 i = 0; i < N; i++) ptrs.push(Mdefault::alloc(64));
+        for(void* ptr : ptrs) Mdefault::free(ptr);
+    });
+
+    bench.run("Mpool::make/destroy"_v, N, [] {
+        for(u64 i = 0; i < N; i++) {
+            Node* node = Mpool::make<Node>();
+            keep(reinterpret_cast<uptr>(node));
+            Mpool::destroy(node);
+        }
+    });
+    bench.run("Mpool::make batch"_v, N, [] {
+        Node* list = null;
+        for(u64 i = 0; i < N; i++) {
+            Node* node = Mpool::make<Node>();
+            node->next = list;
+            list = node;
+        }
+        while(list) {
+            Node* next = list->next;
+            Mpool::destroy(list);
+            list = next;
+        }
+    });
+
+    bench.run("Mframe::alloc/free 256"_v, N, [] {
+        for(u64 i = 0; i < N; i++) {
+            void* ptr = Mframe::alloc(256);
+            keep(reinterpret_cast<uptr>(ptr));
+            Mframe::free(ptr);
+        }
+    });
+
+    bench.run("Region::alloc 64"_v, N, [] {
+        Region(R) {
+            for(u64 i = 0; i < N; i++) keep(reinterpret_cast<uptr>(Mregion<R>::alloc(64)));
+        }
+    });
+    bench.run("Region Vec::push"_v, N, [] {
+        Region(R) {
+            Vec<u64, Mregion<R>> v;
+            for(u64 i = 0; i < N; i++) v.push(i);
+            keep(v.length());
+        }
+    });
+    // Reserve outside the timed region so only the bump allocations are measured.
+    Region_Allocator::reserve(Math::MB(64));
+    bench.run("Region::alloc reserved 64"_v, N, [] {
+        Region(R) {
+            for(u64 i = 0; i < N; i++) keep(reinterpret_cast<uptr>(Mregion<R>::alloc(64)));
+        }
+    });
+    Region_Allocator::reserve(0);
+}
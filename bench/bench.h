@@ -0,0 +1,91 @@
+#include <rpp/base.h>
+
+#include <stdio.h>
+
+using namespace rpp;
+
+// Runs each benchmark WARMUP times untimed, then REPETITIONS times timed, and reports the median
+// and maximum of the per-repetition time per operation. Allocations per operation count the calls
+// to sys_alloc and sys_realloc made by the benchmarking thread, so work done on other threads
+// is not included. Net allocations are only tracked in non-release builds.
+struct Bench {
+    constexpr static u64 WARMUP = 3;
+    constexpr static u64 REPETITIONS = 25;
+
+    explicit Bench(String_View filter, FILE* json) noexcept : filter(filter), json(json) {
+    }
+
+    template<typename F>
+    void run(String_View name, u64 ops, F&& f) noexcept {
+        if(!matches(name)) return;
+
+        for(u64 i = 0; i < WARMUP; i++) f();
+
+        f64 samples[REPETITIONS];
+        u64 allocs = sys_thread_allocs();
+        i64 net = sys_net_allocs();
+
+        for(u64 i = 0; i < REPETITIONS; i++) {
+            u64 begin = Thread::perf_counter();
+            f();
+            u64 end = Thread::perf_counter();
+            samples[i] = static_cast<f64>(end - begin) * 1000000000.0 /
+                         static_cast<f64>(Thread::perf_frequency()) / static_cast<f64>(ops);
+        }
+
+        f64 total_ops = static_cast<f64>(REPETITIONS * ops);
+        f64 allocs_per_op = static_cast<f64>(sys_thread_allocs() - allocs) / total_ops;
+        f64 net_per_op = static_cast<f64>(sys_net_allocs() - net) / total_ops;
+
+        for(u64 i = 1; i < REPETITIONS; i++) {
+            for(u64 j = i; j > 0 && samples[j] < samples[j - 1]; j--) {
+                swap(samples[j], samples[j - 1]);
+            }
+        }
+        f64 median = samples[REPETITIONS / 2];
+        f64 max = samples[REPETITIONS - 1];
+
+        i32 suite_length = static_cast<i32>(suite.length());
+        i32 name_length = static_cast<i32>(name.length());
+        const char* suite_str = reinterpret_cast<const char*>(suite.data());
+        const char* name_str = reinterpret_cast<const char*>(name.data());
+
+        printf("%-12.*s %-28.*s %12.2f ns/op %12.2f max %8.3f allocs/op\n", suite_length,
+               suite_str, name_length, name_str, median, max, allocs_per_op);
+        fflush(stdout);
+
+        if(json) {
+            fprintf(json,
+                    "{\"suite\":\"%.*s\",\"name\":\"%.*s\",\"ops\":%zu,\"median_ns\":%.3f,"
+                    "\"max_ns\":%.3f,\"min_ns\":%.3f,\"allocs_per_op\":%.4f,"
+                    "\"net_allocs_per_op\":%.4f}\n",
+                    suite_length, suite_str, name_length, name_str, ops, median, max, samples[0],
+                    allocs_per_op, net_per_op);
+        }
+    }
+
+    // Selects benchmarks whose suite/name contains the filter.
+    [[nodiscard]] bool matches(String_View name) const noexcept {
+        if(filter.empty()) return true;
+        auto path = format<Mhidden>("%/%"_v, suite, name);
+        for(u64 i = 0; i + filter.length() <= path.length(); i++) {
+            if(path.view().sub(i, i + filter.length()) == filter) return true;
+        }
+        return false;
+    }
+
+    String_View suite;
+    String_View filter;
+    FILE* json = null;
+};
+
+// Stores a result where the optimizer cannot discard the work that produced it.
+inline void keep(u64 value) noexcept {
+    static volatile u64 sink = 0;
+    sink = value;
+}
+
+void bench_containers(Bench& bench) noexcept;
+void bench_allocators(Bench& bench) noexcept;
+void bench_format(Bench& bench) noexcept;
+void bench_pool(Bench& bench) noexcept;
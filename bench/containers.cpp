@@ -0,0 +1,94 @@
+
+#include "bench.h"
+
+#include <rpp/heap.h>
+
+constexpr u64 N = 10000;
+
+// Spreads sequential keys over the table like real hashes would.
+[[nodiscard]] static u64 key(u64 i) noexcept {
+    return i * 0x9e3779b97f4a7c15ull;
+}
+
+void bench_containers(Bench& bench) noexcept {
+    bench.suite = "containers"_v;
+
+    bench.run("Vec::push"_v, N, [] {
+        Vec<u64> v;
+        for(u64 i = 0; i < N; i++) v.push(i);
+        keep(v.length());
+    });
+    bench.run("Vec::push reserved"_v, N, [] {
+        Vec<u64> v;
+        v.reserve(N);
+        for(u64 i = 0; i < N; i++) v.push(i);
+        keep(v.length());
+    });
+    {
+        Vec<u64> v;
+        for(u64 i = 0; i < N; i++) v.push(i);
+        bench.run("Vec::iterate"_v, N, [&v] {
+            u64 sum = 0;
+            for(u64 i : v) sum += i;
+            keep(sum);
+        });
+    }
+    bench.run("Queue::push/pop"_v, N, [] {
+        Queue<u64> q;
+        u64 sum = 0;
+        for(u64 i = 0; i < N; i++) {
+            q.push(i);
+            if(i % 4 == 3) {
+                sum += q.front();
+                q.pop();
+            }
+        }
+        keep(sum + q.length());
+    });
+    bench.run("Heap::push/pop"_v, N, [] {
+        Heap<u64> h;
+        for(u64 i = 0; i < N; i++) h.push(key(i));
+        u64 sum = 0;
+        while(!h.empty()) {
+            sum += h.top();
+            h.pop();
+        }
+        keep(sum);
+    });
+
+    bench.run("Map::insert"_v, N, [] {
+        Map<u64, u64> m;
+        for(u64 i = 0; i < N; i++) m.insert(key(i), i);
+        keep(m.length());
+    });
+    {
+        Map<u64, u64> m;
+        for(u64 i = 0; i < N; i++) m.insert(key(i), i);
+
+        bench.run("Map::try_get hit"_v, N, [&m] {
+            u64 sum = 0;
+            for(u64 i = 0; i < N; i++) sum += **m.try_get(key(i));
+            keep(sum);
+        });
+        bench.run("Map::try_get miss"_v, N, [&m] {
+            u64 misses = 0;
+            for(u64 i = 0; i < N; i++) misses += !m.try_get(key(i + N)).ok();
+            keep(misses);
+        });
+    }
+    bench.run("Map::insert/erase"_v, N, [] {
+        Map<u64, u64> m;
+        for(u64 i = 0; i < N; i++) {
+            m.insert(key(i), i);
+            if(i >= 64) m.erase(key(i - 64));
+        }
+        keep(m.length());
+    });
+    bench.run("Map<String_View>::insert"_v, N, [] {
+        Map<String_View, u64> m;
+        String_View words[] = {"alpha"_v, "beta"_v, "gamma"_v, "delta"_v, "epsilon"_v,
+                               "zeta"_v,  "eta"_v,  "theta"_v, "iota"_v,  "kappa"_v};
+        for(u64 i = 0; i < N; i++) m.insert(words[i % 10], i);
+        keep(m.length());
+    });
+}
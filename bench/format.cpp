@@ -0,0 +1,47 @@
+
+#include "bench.h"
+
+constexpr u64 N = 10000;
+
+struct Point {
+    i32 x, y;
+};
+
+RPP_RECORD(Point, RPP_FIELD(x), RPP_FIELD(y));
+
+void bench_format(Bench& bench) noexcept {
+    bench.suite = "format"_v;
+
+    bench.run("format integer"_v, N, [] {
+        u64 length = 0;
+        for(u64 i = 0; i < N; i++) length += format<Mhidden>("%"_v, i * 7919).length();
+        keep(length);
+    });
+    bench.run("format float"_v, N, [] {
+        u64 length = 0;
+        for(u64 i = 0; i < N; i++) {
+            length += format<Mhidden>("%"_v, static_cast<f64>(i) * 0.37).length();
+        }
+        keep(length);
+    });
+    bench.run("format string"_v, N, [] {
+        u64 length = 0;
+        for(u64 i = 0; i < N; i++) {
+            length += format<Mhidden>("[%] %"_v, "key"_v, "value"_v).length();
+        }
+        keep(length);
+    });
+    bench.run("format record"_v, N, [] {
+        u64 length = 0;
+        for(u64 i = 0; i < N; i++) {
+            length += format<Mhidden>("%"_v, Point{static_cast<i32>(i), -1}).length();
+        }
+        keep(length);
+    });
+    bench.run("format vec"_v, N / 10, [] {
+        Vec<i32> v{1, 2, 3, 4, 5, 6, 7, 8};
+        u64 length = 0;
+        for(u64 i = 0; i < N / 10; i++) length += format<Mhidden>("%"_v, v).length();
+        keep(length);
+    });
+}
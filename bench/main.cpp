@@ -0,0 +1,41 @@
+
+#include "bench.h"
+
+// Usage: rpp_bench [filter] [--json path]
+// Prints one line per benchmark. With --json, also writes one JSON object per line to path for
+// comparing runs. Build with CMAKE_BUILD_TYPE=Release for meaningful numbers.
+i32 main(i32 argc, char** argv) {
+
+    String_View filter;
+    const char* json_path = null;
+
+    for(i32 i = 1; i < argc; i++) {
+        String_View arg = String_View{argv[i]};
+        if(arg == "--json"_v && i + 1 < argc) {
+            json_path = argv[++i];
+        } else {
+            filter = arg;
+        }
+    }
+
+    FILE* json = null;
+    if(json_path) {
+#ifdef RPP_OS_WINDOWS
+        if(fopen_s(&json, json_path, "w")) json = null;
+#else
+        json = fopen(json_path, "w");
+#endif
+        if(!json) die("Failed to open %: %", String_View{json_path}, Log::sys_error());
+    }
+
+    {
+        Bench bench{filter, json};
+        bench_containers(bench);
+        bench_allocators(bench);
+        bench_format(bench);
+        bench_pool(bench);
+    }
+
+    if(json) fclose(json);
+    return 0;
+}
@@ -0,0 +1,45 @@
+
+#include "bench.h"
+
+#include <rpp/pool.h>
+
+template<Allocator F = Async::Alloc>
+static auto fork_join(Async::Pool<>& pool, u64 depth) -> Async::Task<u64, F> {
+    if(depth == 0) {
+        co_return 1;
+    }
+    co_await pool.suspend();
+    auto left = fork_join<F>(pool, depth - 1);
+    auto right = fork_join<F>(pool, depth - 1);
+    co_return co_await left + co_await right;
+}
+
+static auto reschedule(Async::Pool<>& pool, u64 count) -> Async::Task<u64> {
+    for(u64 i = 0; i < count; i++) {
+        co_await pool.suspend();
+    }
+    co_return count;
+}
+
+void bench_pool(Bench& bench) noexcept {
+    bench.suite = "pool"_v;
+
+    if(Thread::hardware_threads() < 2) {
+        printf("Skipping pool benchmarks: no worker threads available.\n");
+        return;
+    }
+
+    Async::Pool pool;
+
+    bench.run("suspend"_v, 1000, [&pool] { keep(reschedule(pool, 1000).block()); });
+    bench.run("fork/join depth 10"_v, 1 << 10, [&pool] { keep(fork_join(pool, 10).block()); });
+    bench.run("fork/join depth 10 Mframe"_v, 1 << 10,
+              [&pool] { keep(fork_join<Mframe>(pool, 10).block()); });
+    bench.run("independent tasks"_v, 256, [&pool] {
+        Vec<Async::Task<u64>> tasks;
+        for(u64 i = 0; i < 256; i++) tasks.push(reschedule(pool, 1));
+        u64 sum = 0;
+        for(auto& task : tasks) sum += task.block();
+        keep(sum);
+    });
+}
@@ -7,17 +7,39 @@
 
 namespace rpp {
 
+// Alignment of memory returned by allocators when none is requested.
+constexpr u64 DEFAULT_ALIGNMENT = 16;
+
 [[nodiscard]] void* sys_alloc(u64 size) noexcept;
+[[nodiscard]] void* sys_alloc(u64 size, u64 align) noexcept;
+[[nodiscard]] void* sys_realloc(void* mem, u64 size) noexcept;
 void sys_free(void* mem) noexcept;
 [[nodiscard]] i64 sys_net_allocs() noexcept;
+// Calls to sys_alloc and sys_realloc made by the calling thread. Counted in all builds.
+[[nodiscard]] u64 sys_thread_allocs() noexcept;
+
+// Virtual memory: reserved ranges are inaccessible until committed. Discarded pages stay
+// committed, but their contents may be reclaimed by the OS.
+[[nodiscard]] void* sys_reserve(u64 size) noexcept;
+void sys_commit(void* mem, u64 size) noexcept;
+void sys_discard(void* mem, u64 size) noexcept;
+void sys_release(void* mem, u64 size) noexcept;
 
 template<typename A>
-concept Allocator = requires(u64 size, void* address) {
+concept Allocator = requires(u64 size, u64 align, void* address) {
     Same<Literal, decltype(A::name)>;
     { A::alloc(size) } -> Same<void*>;
+    { A::alloc(size, align) } -> Same<void*>;
     { A::free(address) } -> Same<void>;
 };
 
+// Allocators may also provide realloc, which preserves the first min(old_size, new_size) bytes
+// and may resize the allocation in place.
+template<typename A>
+concept Reallocator = Allocator<A> && requires(void* address, u64 size, u64 align) {
+    { A::realloc(address, size, size, align) } -> Same<void*>;
+};
+
 template<typename A>
 concept Pool = requires(Empty<> t) { // Can't express forall types T
     { A::template make<Empty<>>(t) } -> Same<Empty<>*>;
@@ -34,7 +56,7 @@ struct Scalar_Adaptor {
     template<typename T, typename... Args>
         requires Allocator<A> && Constructable<T, Args...>
     [[nodiscard]] static T* make(Args&&... args) noexcept {
-        T* mem = reinterpret_cast<T*>(A::alloc(sizeof(T)));
+        T* mem = reinterpret_cast<T*>(A::alloc(sizeof(T), alignof(T)));
         new(mem) T{rpp::forward<Args>(args)...};
         return mem;
     }
@@ -58,6 +80,8 @@ template<Literal N, bool Log = true>
 struct Mallocator {
     constexpr static Literal name = N;
     static void* alloc(u64 size) noexcept;
+    static void* alloc(u64 size, u64 align) noexcept;
+    static void* realloc(void* mem, u64 old_size, u64 new_size, u64 align) noexcept;
     static void free(void* mem) noexcept;
 };
 
@@ -81,12 +105,21 @@ struct Region_Allocator {
         Scope& operator=(Scope&&) = delete;
     };
 
-    [[nodiscard]] static void* alloc(Region region, u64 size) noexcept;
+    [[nodiscard]] static void* alloc(Region region, u64 size,
+                                     u64 align = DEFAULT_ALIGNMENT) noexcept;
+    [[nodiscard]] static void* realloc(Region region, void* mem, u64 old_size, u64 new_size,
+                                       u64 align = DEFAULT_ALIGNMENT) noexcept;
     static void free(Region region, void* mem) noexcept;
 
     static u64 depth() noexcept;
     static u64 size() noexcept;
 
+    // Backs this thread's regions with a single reserved virtual range instead of chunks.
+    // Pages are committed on demand, so allocation is a pointer bump. If discard is set, pages
+    // are handed back to the OS whenever the outermost region ends. Must be called outside of
+    // any region; a size of zero returns to the chunked backend.
+    static void reserve(u64 size, bool discard = false) noexcept;
+
 private:
     static void begin(Region region) noexcept;
     static void end(Region region) noexcept;
@@ -100,6 +133,12 @@ struct Mregion {
     [[nodiscard]] static void* alloc(u64 size) noexcept {
         return Region_Allocator::alloc(R, size);
     }
+    [[nodiscard]] static void* alloc(u64 size, u64 align) noexcept {
+        return Region_Allocator::alloc(R, size, align);
+    }
+    [[nodiscard]] static void* realloc(void* mem, u64 old_size, u64 new_size, u64 align) noexcept {
+        return Region_Allocator::realloc(R, mem, old_size, new_size, align);
+    }
     static void free(void* mem) noexcept {
         Region_Allocator::free(R, mem);
     }
@@ -164,7 +203,7 @@ private:
             list_ = list_->next;
             return reinterpret_cast<T*>(ret);
         }
-        void* new_node = Base::alloc(sizeof(Free_Node));
+        void* new_node = Base::alloc(sizeof(Free_Node), alignof(Free_Node));
         return reinterpret_cast<T*>(new_node);
     }
 
@@ -183,4 +222,179 @@ private:
     Free_Node* list_ = null;
 };
 
+namespace detail {
+
+[[nodiscard]] consteval u64 slab_size(u64 node_size) noexcept {
+    // At least 16KB, and enough for 32 nodes.
+    u64 size = Math::KB(16);
+    while(size < node_size * 32 + 64) size *= 2;
+    return size;
+}
+
+} // namespace detail
+
+template<typename T, Allocator Base, u64 Slab_Size = detail::slab_size(sizeof(T))>
+struct Slab_List {
+    // Free list that carves nodes out of slabs aligned to Slab_Size, so a node's slab is found
+    // by masking its address. Slabs that become empty are released, except
+    // for the last partially used one.
+
+    static_assert((Slab_Size & (Slab_Size - 1)) == 0, "Slab_Size must be a power of two.");
+
+    struct Statistics {
+        u64 slabs = 0;
+        u64 capacity = 0;
+        u64 used = 0;
+    };
+
+    Slab_List() noexcept = default;
+    ~Slab_List() noexcept {
+        clear();
+    }
+
+    Slab_List(const Slab_List&) noexcept = delete;
+    Slab_List& operator=(const Slab_List&) noexcept = delete;
+
+    Slab_List(Slab_List&& src) noexcept
+        : partial_(src.partial_), full_(src.full_), slabs_(src.slabs_), used_(src.used_) {
+        src.partial_ = null;
+        src.full_ = null;
+        src.slabs_ = 0;
+        src.used_ = 0;
+    }
+    Slab_List& operator=(Slab_List&& src) noexcept {
+        this->~Slab_List();
+        partial_ = src.partial_;
+        full_ = src.full_;
+        slabs_ = src.slabs_;
+        used_ = src.used_;
+        src.partial_ = null;
+        src.full_ = null;
+        src.slabs_ = 0;
+        src.used_ = 0;
+        return *this;
+    }
+
+    template<typename... Args>
+        requires Constructable<T, Args...>
+    [[nodiscard]] T* make(Args&&... args) noexcept {
+        return new(alloc()) T{rpp::forward<Args>(args)...};
+    }
+
+    void destroy(T* value) noexcept {
+        if constexpr(Must_Destruct<T>) {
+            value->~T();
+        }
+        free(value);
+    }
+
+    // Releases all empty slabs. Slabs containing live nodes are kept.
+    void clear() noexcept {
+        Slab* slab = partial_;
+        while(slab) {
+            Slab* next = slab->next;
+            if(slab->used == 0) release(slab);
+            slab = next;
+        }
+    }
+
+    [[nodiscard]] Statistics statistics() const noexcept {
+        return Statistics{slabs_, slabs_ * NODES_PER_SLAB, used_};
+    }
+
+private:
+    union Free_Node {
+        ~Free_Node() = delete;
+        T value;
+        Free_Node* next = null;
+    };
+
+    struct Slab {
+        Slab* prev = null;
+        Slab* next = null;
+        Free_Node* free = null;
+        u64 bump = 0;
+        u64 used = 0;
+
+        [[nodiscard]] Free_Node* nodes() noexcept {
+            return reinterpret_cast<Free_Node*>(reinterpret_cast<u8*>(this) + NODES_OFFSET);
+        }
+    };
+
+    constexpr static u64 NODES_OFFSET = Math::align_pow2(sizeof(Slab), alignof(Free_Node));
+    constexpr static u64 NODES_PER_SLAB = (Slab_Size - NODES_OFFSET) / sizeof(Free_Node);
+    static_assert(NODES_PER_SLAB > 0);
+
+    [[nodiscard]] T* alloc() noexcept {
+        Slab* slab = partial_ ? partial_ : new_slab();
+
+        Free_Node* node = null;
+        if(slab->free) {
+            node = slab->free;
+            slab->free = node->next;
+        } else {
+            node = slab->nodes() + slab->bump++;
+        }
+        slab->used++;
+        used_++;
+
+        if(slab->used == NODES_PER_SLAB) {
+            unlink(partial_, slab);
+            link(full_, slab);
+        }
+        return reinterpret_cast<T*>(node);
+    }
+
+    void free(T* mem) noexcept {
+        Slab* slab = reinterpret_cast<Slab*>(reinterpret_cast<uptr>(mem) & ~(Slab_Size - 1));
+        Free_Node* node = reinterpret_cast<Free_Node*>(mem);
+        node->next = slab->free;
+        slab->free = node;
+
+        if(slab->used == NODES_PER_SLAB) {
+            unlink(full_, slab);
+            link(partial_, slab);
+        }
+        slab->used--;
+        used_--;
+
+        if(slab->used == 0 && (slab->prev || slab->next)) {
+            release(slab);
+        }
+    }
+
+    [[nodiscard]] Slab* new_slab() noexcept {
+        Slab* slab = new(Base::alloc(Slab_Size, Slab_Size)) Slab{};
+        link(partial_, slab);
+        slabs_++;
+        return slab;
+    }
+
+    void release(Slab* slab) noexcept {
+        unlink(partial_, slab);
+        slabs_--;
+        Base::free(slab);
+    }
+
+    static void link(Slab*& list, Slab* slab) noexcept {
+        slab->prev = null;
+        slab->next = list;
+        if(list) list->prev = slab;
+        list = slab;
+    }
+
+    static void unlink(Slab*& list, Slab* slab) noexcept {
+        if(slab->prev) slab->prev->next = slab->next;
+        if(slab->next) slab->next->prev = slab->prev;
+        if(list == slab) list = slab->next;
+        slab->prev = null;
+        slab->next = null;
+    }
+
+    Slab* partial_ = null;
+    Slab* full_ = null;
+    u64 slabs_ = 0;
+    u64 used_ = 0;
+};
+
 } // namespace rpp
@@ -23,54 +23,96 @@ namespace detail {
     return ret;
 }
 
-template<u64 N>
+template<u64 N, u64 Align>
 struct Pool {
     constexpr static Literal name = pool_name(N);
 
     template<typename T, typename... Args>
-        requires(sizeof(T) == N) && Constructable<T, Args...>
+        requires(sizeof(T) == N) && (alignof(T) == Align) && Constructable<T, Args...>
     [[nodiscard]] static T* make(Args&&... args) noexcept {
-        finalizer.keep_alive();
-        Block* block = null;
-        {
-            Thread::Lock lock(mutex);
-            block = list.make();
-        }
-        new(block->data) T{rpp::forward<Args>(args)...};
-        return reinterpret_cast<T*>(block);
+        return new(alloc()) T{rpp::forward<Args>(args)...};
     }
 
     template<typename T>
-        requires(sizeof(T) == N)
+        requires(sizeof(T) == N) && (alignof(T) == Align)
     static void destroy(T* value) noexcept {
-        finalizer.keep_alive();
         if constexpr(Must_Destruct<T>) {
             value->~T();
         }
-        {
-            Thread::Lock lock(mutex);
-            list.destroy(reinterpret_cast<Block*>(value));
-        }
+        free(value);
+    }
+
+    [[nodiscard]] static void* alloc() noexcept {
+        finalizer.keep_alive();
+        Magazine& local = magazine;
+        if(local.length == 0) local.refill();
+        return local.blocks[--local.length]->data;
+    }
+
+    static void free(void* mem) noexcept {
+        finalizer.keep_alive();
+        Magazine& local = magazine;
+        if(local.length == MAGAZINE_SIZE) local.flush(MAGAZINE_SIZE / 2);
+        local.blocks[local.length++] = reinterpret_cast<Block*>(mem);
     }
 
 private:
     using Backing = Mallocator<name>;
 
     struct Block {
-        alignas(Math::min<u64>(N, 16)) u8 data[N];
+        alignas(Align) u8 data[N];
+    };
+
+    // Each thread caches free blocks in a magazine that is refilled from and flushed to the
+    // shared slab list in batches, so the mutex is only taken once per batch.
+    constexpr static u64 MAGAZINE_SIZE = 64;
+
+    struct Magazine {
+        Magazine() noexcept = default;
+        ~Magazine() noexcept {
+            flush(length);
+        }
+
+        Magazine(const Magazine&) noexcept = delete;
+        Magazine& operator=(const Magazine&) noexcept = delete;
+
+        Magazine(Magazine&&) noexcept = delete;
+        Magazine& operator=(Magazine&&) noexcept = delete;
+
+        void refill() noexcept {
+            Thread::Lock lock(mutex);
+            while(length < MAGAZINE_SIZE / 2) {
+                blocks[length++] = list.make();
+            }
+        }
+        void flush(u64 count) noexcept {
+            if(count == 0) return;
+            Thread::Lock lock(mutex);
+            for(; count > 0; count--) {
+                list.destroy(blocks[--length]);
+            }
+        }
+
+        Block* blocks[MAGAZINE_SIZE];
+        u64 length = 0;
     };
 
     struct Finalizer {
-        Finalizer(Free_List<Block, Backing>& l) noexcept {
-            Profile::finalizer([&l]() { l.clear(); });
+        Finalizer(Slab_List<Block, Backing>& l) noexcept {
+            Profile::finalizer([&l]() {
+                magazine.flush(magazine.length);
+                Thread::Lock lock(mutex);
+                l.clear();
+            });
         }
         consteval void keep_alive() noexcept {
         }
     };
 
     static inline Thread::Mutex mutex;
-    static inline Free_List<Block, Backing> list;
+    static inline Slab_List<Block, Backing> list;
     static inline Finalizer finalizer{list};
+    static inline thread_local Magazine magazine;
 };
 
 } // namespace detail
@@ -79,12 +121,89 @@ struct Mpool {
     template<typename T, typename... Args>
         requires Constructable<T, Args...>
     [[nodiscard]] constexpr static T* make(Args&&... args) noexcept {
-        return detail::Pool<sizeof(T)>::template make<T, Args...>(rpp::forward<Args>(args)...);
+        return detail::Pool<sizeof(T), alignof(T)>::template make<T, Args...>(
+            rpp::forward<Args>(args)...);
     }
 
     template<typename T>
     constexpr static void destroy(T* value) noexcept {
-        detail::Pool<sizeof(T)>::template destroy<T>(value);
+        detail::Pool<sizeof(T), alignof(T)>::template destroy<T>(value);
+    }
+};
+
+// Recycles short-lived allocations, such as coroutine frames, through the same per-thread
+// magazines as Mpool, bucketed by power of two sizes. Blocks freed on another thread join that
+// thread's magazine and return to the shared slabs in batches. Each block starts with a header
+// naming its size class; larger or overaligned requests go to the backing allocator.
+struct Mframe {
+    constexpr static Literal name = "Frame";
+
+    [[nodiscard]] static void* alloc(u64 size) noexcept {
+        return alloc(size, DEFAULT_ALIGNMENT);
+    }
+
+    [[nodiscard]] static void* alloc(u64 size, u64 align) noexcept {
+        if(!size) return null;
+        u64 total = size + sizeof(Header);
+        if(align <= DEFAULT_ALIGNMENT && total <= MAX_SIZE) {
+            u64 size_class = Math::max(64 - Math::ctlz(total - 1), MIN_LOG2) - MIN_LOG2;
+            return finish(alloc_class(size_class), sizeof(Header), size_class);
+        }
+        align = Math::max(align, DEFAULT_ALIGNMENT);
+        return finish(Backing::alloc(size + align, align), align, LARGE);
+    }
+
+    static void free(void* mem) noexcept {
+        if(!mem) return;
+        Header* header = reinterpret_cast<Header*>(mem) - 1;
+        if(header->size_class == LARGE) {
+            Backing::free(header->base);
+        } else {
+            free_class(header->size_class, header->base);
+        }
+    }
+
+private:
+    using Backing = Mallocator<name>;
+
+    struct alignas(DEFAULT_ALIGNMENT) Header {
+        u64 size_class = 0;
+        void* base = null;
+    };
+
+    constexpr static u64 MIN_LOG2 = 6;
+    constexpr static u64 CLASSES = 7;
+    constexpr static u64 MAX_SIZE = u64{1} << (MIN_LOG2 + CLASSES - 1);
+    constexpr static u64 LARGE = CLASSES;
+
+    template<u64 C>
+    using Class = detail::Pool<u64{1} << (MIN_LOG2 + C), DEFAULT_ALIGNMENT>;
+
+    [[nodiscard]] static void* finish(void* base, u64 offset, u64 size_class) noexcept {
+        Header* header = reinterpret_cast<Header*>(reinterpret_cast<u8*>(base) + offset) - 1;
+        header->size_class = size_class;
+        header->base = base;
+        return header + 1;
+    }
+
+    template<u64 C = 0>
+    [[nodiscard]] static void* alloc_class(u64 size_class) noexcept {
+        if constexpr(C < CLASSES) {
+            if(size_class == C) return Class<C>::alloc();
+            return alloc_class<C + 1>(size_class);
+        } else {
+            RPP_UNREACHABLE;
+        }
+    }
+
+    template<u64 C = 0>
+    static void free_class(u64 size_class, void* block) noexcept {
+        if constexpr(C < CLASSES) {
+            if(size_class == C) return Class<C>::free(block);
+            free_class<C + 1>(size_class, block);
+        } else {
+            RPP_UNREACHABLE;
+        }
     }
 };
 
@@ -92,8 +211,45 @@ template<Literal N, bool log>
 [[nodiscard]] void* Mallocator<N, log>::alloc(u64 size) noexcept {
     if(!size) return null;
     void* ret = sys_alloc(size);
-    if constexpr(log) {
-        Profile::alloc({String_View{N}, ret, size});
+    if constexpr(log && DO_PROFILE) {
+        Profile::alloc({String_View{N}, ret, size, Profile::allocator_id<N>()});
+    }
+    return ret;
+}
+
+template<Literal N, bool log>
+[[nodiscard]] void* Mallocator<N, log>::alloc(u64 size, u64 align) noexcept {
+    if(!size) return null;
+    void* ret = sys_alloc(size, align);
+    if constexpr(log && DO_PROFILE) {
+        Profile::alloc({String_View{N}, ret, size, Profile::allocator_id<N>()});
+    }
+    return ret;
+}
+
+template<Literal N, bool log>
+[[nodiscard]] void* Mallocator<N, log>::realloc(void* mem, u64 old_size, u64 new_size,
+                                               u64 align) noexcept {
+    if(!mem) return alloc(new_size, align);
+    if(!new_size) {
+        free(mem);
+        return null;
+    }
+    if(align > DEFAULT_ALIGNMENT) {
+        // The system realloc only preserves the default alignment.
+        void* ret = alloc(new_size, align);
+        Libc::memcpy(ret, mem, Math::min(old_size, new_size));
+        free(mem);
+        return ret;
+    }
+    // Record the free first: once the block is released, another thread may be handed the
+    // same address and record its allocation before we do.
+    if constexpr(log && DO_PROFILE) {
+        Profile::alloc({String_View{N}, mem, 0, Profile::allocator_id<N>()});
+    }
+    void* ret = sys_realloc(mem, new_size);
+    if constexpr(log && DO_PROFILE) {
+        Profile::alloc({String_View{N}, ret, new_size, Profile::allocator_id<N>()});
     }
     return ret;
 }
@@ -101,8 +257,8 @@ template<Literal N, bool log>
 template<Literal N, bool log>
 void Mallocator<N, log>::free(void* mem) noexcept {
     if(!mem) return;
-    if constexpr(log) {
-        Profile::alloc({String_View{N}, mem, 0});
+    if constexpr(log && DO_PROFILE) {
+        Profile::alloc({String_View{N}, mem, 0, Profile::allocator_id<N>()});
     }
     sys_free(mem);
 }
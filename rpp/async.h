@@ -46,6 +46,40 @@ constexpr i64 TASK_START = 0;
 constexpr i64 TASK_DONE = 1;
 constexpr i64 TASK_ABANDONED = 2;
 
+namespace detail {
+
+struct Join_Access;
+
+// Waiter shared by every task in a when_all or when_any. Instead of a coroutine address, each
+// task's state holds the join's address with the low bit set. Each task releases one reference
+// when it completes, or is released on its behalf if it was already done or gets detached; the
+// last release resumes the waiting coroutine, so it runs exactly once.
+struct Join {
+    Thread::Atomic pending;
+    Thread::Atomic fired;
+    std::coroutine_handle<> continuation;
+    // Only set by when_any: called once, by the first task to complete, to detach the rest.
+    void (*detach)(Join&) noexcept = null;
+
+    [[nodiscard]] i64 tag() const noexcept {
+        return reinterpret_cast<i64>(this) | 1;
+    }
+    [[nodiscard]] static bool is_tag(i64 state) noexcept {
+        return state > TASK_ABANDONED && (state & 1);
+    }
+    [[nodiscard]] static Join& of_tag(i64 state) noexcept {
+        return *reinterpret_cast<Join*>(state & ~i64{1});
+    }
+
+    [[nodiscard]] std::coroutine_handle<> complete() noexcept {
+        if(detach && fired.exchange(1) == 0) detach(*this);
+        if(pending.decr() == 0) return continuation;
+        return std::noop_coroutine();
+    }
+};
+
+} // namespace detail
+
 struct Final_Suspend {
     [[nodiscard]] bool await_ready() noexcept {
         return false;
@@ -61,6 +95,8 @@ struct Final_Suspend {
 
         if(state == TASK_ABANDONED) {
             handle.destroy();
+        } else if(detail::Join::is_tag(state)) {
+            return detail::Join::of_tag(state).complete();
         } else if(state != TASK_START) {
             return std::coroutine_handle<>::from_address(reinterpret_cast<void*>(state));
         }
@@ -224,7 +260,13 @@ struct Task {
     }
 
 private:
+    [[nodiscard]] Thread::Atomic& state() noexcept {
+        assert(handle);
+        return handle.promise().state;
+    }
+
     std::coroutine_handle<Promise<R, A>> handle;
+    friend struct detail::Join_Access;
 };
 
 template<Allocator A>
@@ -240,6 +282,146 @@ struct Promise<void, A> : Promise_Base<void, A> {
     }
 };
 
+namespace detail {
+
+struct Join_Access {
+    template<typename R, Allocator A>
+    [[nodiscard]] static Thread::Atomic& state(Task<R, A>& task) noexcept {
+        return task.state();
+    }
+};
+
+template<typename R, Allocator A>
+struct Task_States {
+    Slice<Task<R, A>> tasks;
+
+    [[nodiscard]] u64 length() const noexcept {
+        return tasks.length();
+    }
+    [[nodiscard]] Thread::Atomic& operator[](u64 i) noexcept {
+        return Join_Access::state(tasks[i]);
+    }
+};
+
+template<u64 N>
+struct Atomic_States {
+    Thread::Atomic* states[N];
+
+    [[nodiscard]] constexpr u64 length() const noexcept {
+        return N;
+    }
+    [[nodiscard]] Thread::Atomic& operator[](u64 i) noexcept {
+        return *states[i];
+    }
+};
+
+// Awaits every task, or only the first to complete if Any is set. Registering with a task
+// that has already completed is released immediately, so the awaiter never suspends on a
+// task that is done. The awaiter holds its own reference while registering, so no task can
+// resume it before await_suspend is finished with the join.
+template<typename States, bool Any>
+struct When : Join {
+
+    explicit When(States states) noexcept : states_{states} {
+        if constexpr(Any) detach = &detach_rest;
+    }
+
+    When(const When&) noexcept = delete;
+    When& operator=(const When&) noexcept = delete;
+
+    When(When&&) noexcept = delete;
+    When& operator=(When&&) noexcept = delete;
+
+    [[nodiscard]] bool await_ready() noexcept {
+        u64 done = 0;
+        for(u64 i = 0; i < states_.length(); i++) {
+            if(states_[i].load() == TASK_DONE) done++;
+        }
+        if constexpr(Any) {
+            return done > 0;
+        } else {
+            return done == states_.length();
+        }
+    }
+
+    [[nodiscard]] bool await_suspend(std::coroutine_handle<> handle) noexcept {
+        continuation = handle;
+        pending.exchange(static_cast<i64>(states_.length() + 1));
+
+        for(u64 i = 0; i < states_.length(); i++) {
+            if(Any && fired.load() != 0) {
+                pending.decr();
+                continue;
+            }
+            i64 state = states_[i].compare_and_swap(TASK_START, tag());
+            if(state != TASK_START) {
+                assert(state == TASK_DONE);
+                if(Any && fired.exchange(1) == 0) detach_rest(*this);
+                pending.decr();
+            } else if(Any && fired.load() != 0) {
+                // Another task fired before this one was tagged, so detach_rest missed it.
+                if(states_[i].compare_and_swap(tag(), TASK_START) == tag()) pending.decr();
+            }
+        }
+        return pending.decr() != 0;
+    }
+
+    // Returns the index of a completed task for when_any.
+    [[nodiscard]] auto await_resume() noexcept {
+        if constexpr(Any) {
+            for(u64 i = 0; i < states_.length(); i++) {
+                if(states_[i].load() == TASK_DONE) return i;
+            }
+            RPP_UNREACHABLE;
+        }
+    }
+
+private:
+    // A task either gets detached here or completes and releases itself, never both.
+    static void detach_rest(Join& join) noexcept {
+        When& self = static_cast<When&>(join);
+        for(u64 i = 0; i < self.states_.length(); i++) {
+            if(self.states_[i].compare_and_swap(self.tag(), TASK_START) == self.tag()) {
+                self.pending.decr();
+            }
+        }
+    }
+
+    States states_;
+};
+
+} // namespace detail
+
+// Resumes the awaiting coroutine once every task has completed. The tasks are still owned by
+// the caller, and awaiting one afterwards returns its result without suspending. Each task
+// may only be awaited by one coroutine at a time.
+template<typename R, Allocator A>
+[[nodiscard]] auto when_all(Slice<Task<R, A>> tasks) noexcept {
+    return detail::When<detail::Task_States<R, A>, false>{detail::Task_States<R, A>{tasks}};
+}
+
+template<typename... Rs, Allocator... As>
+    requires(sizeof...(Rs) > 0)
+[[nodiscard]] auto when_all(Task<Rs, As>&... tasks) noexcept {
+    using States = detail::Atomic_States<sizeof...(Rs)>;
+    return detail::When<States, false>{States{{&detail::Join_Access::state(tasks)...}}};
+}
+
+// Resumes the awaiting coroutine once any task has completed, returning its index. The
+// remaining tasks keep running and may be awaited or dropped as usual.
+template<typename R, Allocator A>
+[[nodiscard]] auto when_any(Slice<Task<R, A>> tasks) noexcept {
+    assert(tasks.length() > 0);
+    return detail::When<detail::Task_States<R, A>, true>{detail::Task_States<R, A>{tasks}};
+}
+
+template<typename... Rs, Allocator... As>
+    requires(sizeof...(Rs) > 0)
+[[nodiscard]] auto when_any(Task<Rs, As>&... tasks) noexcept {
+    using States = detail::Atomic_States<sizeof...(Rs)>;
+    return detail::When<States, true>{States{{&detail::Join_Access::state(tasks)...}}};
+}
+
 struct Event {
 
     Event() noexcept;
@@ -282,6 +464,39 @@ private:
     i32 signal_fd = -1;
     i16 mask = 0;
 #endif
+
+    friend struct Reactor;
+};
+
+struct Reactor {
+    // Long-lived set of events, each registered once under a caller-provided id.
+    // wait() blocks until at least one registered event is ready or timeout_ms elapses, and
+    // writes the ids of up to ready.length() ready events, returning how many were written
+    // (zero on timeout). An event stays registered until it is removed, so signaled events
+    // must be removed or reset.
+
+    constexpr static u64 NO_TIMEOUT = Limits<u64>::max();
+
+    Reactor() noexcept;
+    ~Reactor() noexcept;
+
+    Reactor(const Reactor&) noexcept = delete;
+    Reactor& operator=(const Reactor&) noexcept = delete;
+
+    Reactor(Reactor&&) noexcept = delete;
+    Reactor& operator=(Reactor&&) noexcept = delete;
+
+    void add(const Event& event, u64 id) noexcept;
+    void remove(const Event& event) noexcept;
+    [[nodiscard]] u64 wait(Slice<u64> ready, u64 timeout_ms = NO_TIMEOUT) noexcept;
+
+private:
+#ifdef RPP_OS_WINDOWS
+    Vec<void*, Alloc> handles;
+    Vec<u64, Alloc> ids;
+#else
+    i32 fd = -1;
+#endif
 };
 
 } // namespace rpp::Async
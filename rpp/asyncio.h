@@ -7,7 +7,9 @@
 
 namespace rpp::Async {
 
-[[nodiscard]] Task<void> wait(Pool<>& pool, u64 ms) noexcept;
+[[nodiscard]] inline Task<void> wait(Pool<>& pool, u64 ms) noexcept {
+    co_await pool.timer(ms);
+}
 
 [[nodiscard]] Task<Opt<Vec<u8, Files::Alloc>>> read(Pool<>& pool, String_View path) noexcept;
 [[nodiscard]] Task<bool> write(Pool<>& pool, String_View path, Slice<u8> data) noexcept;
@@ -112,6 +112,7 @@ namespace Libc {
 [[nodiscard]] u64 strlen(const char* str) noexcept;
 void* memset(void* dest, i32 value, u64 bytes) noexcept;
 void* memcpy(void* dest, const void* src, u64 bytes) noexcept;
+void* memmove(void* dest, const void* src, u64 bytes) noexcept;
 [[nodiscard]] i32 memcmp(const void* a, const void* b, u64 bytes) noexcept;
 [[nodiscard]] i32 snprintf(u8* buffer, u64 buffer_size, const char* fmt, ...) noexcept;
 [[nodiscard]] i64 strtoll(const char* str, char** endptr, i32 base) noexcept;
@@ -0,0 +1,211 @@
+
+#pragma once
+
+#include "base.h"
+
+namespace rpp {
+
+// Hash map that may be used from many threads at once. Keys are spread over independently
+// locked shards, each a Map guarded by a reader-writer lock, so lookups only contend with
+// writes to the same shard. References into the map cannot outlive a lock, so values are
+// returned by copy or accessed in place through a callback that runs under the shard's lock.
+// Callbacks must not access the same map.
+template<Key K, Move_Constructable V, Allocator A = Mdefault, u64 S = 64>
+    requires(S > 0 && (S & (S - 1)) == 0)
+struct Concurrent_Map {
+
+    Concurrent_Map() noexcept = default;
+    ~Concurrent_Map() noexcept = default;
+
+    Concurrent_Map(const Concurrent_Map&) noexcept = delete;
+    Concurrent_Map& operator=(const Concurrent_Map&) noexcept = delete;
+
+    Concurrent_Map(Concurrent_Map&&) noexcept = delete;
+    Concurrent_Map& operator=(Concurrent_Map&&) noexcept = delete;
+
+    void insert(const K& key, const V& value) noexcept
+        requires Copy_Constructable<K> && Copy_Constructable<V>
+    {
+        insert(K{key}, V{value});
+    }
+
+    void insert(K&& key, const V& value) noexcept
+        requires Copy_Constructable<V>
+    {
+        insert(rpp::move(key), V{value});
+    }
+
+    void insert(const K& key, V&& value) noexcept
+        requires Copy_Constructable<K>
+    {
+        insert(K{key}, rpp::move(value));
+    }
+
+    void insert(K&& key, V&& value) noexcept {
+        Shard& shard = shard_for(key);
+        Thread::Exclusive_Lock lock(shard.lock);
+        shard.map.insert(rpp::move(key), rpp::move(value));
+    }
+
+    [[nodiscard]] Opt<V> try_get(const K& key) const noexcept
+        requires Clone<V> || Copy_Constructable<V>
+    {
+        const Shard& shard = shard_for(key);
+        Thread::Shared_Lock lock(shard.lock);
+        if(Opt<Ref<const V>> value = shard.map.try_get(key); value.ok()) {
+            return Opt<V>{copy(**value)};
+        }
+        return {};
+    }
+
+    [[nodiscard]] bool contains(const K& key) const noexcept {
+        const Shard& shard = shard_for(key);
+        Thread::Shared_Lock lock(shard.lock);
+        return shard.map.contains(key);
+    }
+
+    // Calls f with the value for key while holding the shard's shared lock.
+    template<typename F>
+        requires Invocable<F, const V&>
+    [[nodiscard]] bool read(const K& key, F&& f) const noexcept {
+        const Shard& shard = shard_for(key);
+        Thread::Shared_Lock lock(shard.lock);
+        if(Opt<Ref<const V>> value = shard.map.try_get(key); value.ok()) {
+            rpp::forward<F>(f)(**value);
+            return true;
+        }
+        return false;
+    }
+
+    // Calls f with the value for key while holding the shard's exclusive lock.
+    template<typename F>
+        requires Invocable<F, V&>
+    [[nodiscard]] bool update(const K& key, F&& f) noexcept {
+        Shard& shard = shard_for(key);
+        Thread::Exclusive_Lock lock(shard.lock);
+        if(Opt<Ref<V>> value = shard.map.try_get(key); value.ok()) {
+            rpp::forward<F>(f)(**value);
+            return true;
+        }
+        return false;
+    }
+
+    // Returns the value for key, inserting the result of make if there is none. Make runs at
+    // most once per call, under the shard's exclusive lock.
+    template<typename F>
+        requires Invocable<F> && Same<Invoke_Result<F>, V> && Copy_Constructable<K> &&
+                 (Clone<V> || Copy_Constructable<V>)
+    [[nodiscard]] V get_or_insert(const K& key, F&& make) noexcept {
+        Shard& shard = shard_for(key);
+        {
+            Thread::Shared_Lock lock(shard.lock);
+            if(Opt<Ref<V>> value = shard.map.try_get(key); value.ok()) {
+                return copy(**value);
+            }
+        }
+        Thread::Exclusive_Lock lock(shard.lock);
+        if(Opt<Ref<V>> value = shard.map.try_get(key); value.ok()) {
+            return copy(**value);
+        }
+        return copy(shard.map.insert(K{key}, rpp::forward<F>(make)()));
+    }
+
+    [[nodiscard]] V get_or_insert(const K& key) noexcept
+        requires Copy_Constructable<K> && Default_Constructable<V> &&
+                 (Clone<V> || Copy_Constructable<V>)
+    {
+        return get_or_insert(key, [] { return V{}; });
+    }
+
+    [[nodiscard]] bool try_erase(const K& key) noexcept {
+        Shard& shard = shard_for(key);
+        Thread::Exclusive_Lock lock(shard.lock);
+        return shard.map.try_erase(key);
+    }
+
+    void erase(const K& key) noexcept {
+        if(!try_erase(key)) die("Failed to erase key %!", key);
+    }
+
+    void clear() noexcept {
+        for(Shard& shard : shards_) {
+            Thread::Exclusive_Lock lock(shard.lock);
+            shard.map.clear();
+        }
+    }
+
+    // Shards are counted one at a time, so concurrent writes may be partially reflected.
+    [[nodiscard]] u64 length() const noexcept {
+        u64 length = 0;
+        for(const Shard& shard : shards_) {
+            Thread::Shared_Lock lock(shard.lock);
+            length += shard.map.length();
+        }
+        return length;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return length() == 0;
+    }
+
+    // Calls f with each entry, holding one shard's shared lock at a time. Each shard is seen
+    // consistently, but writes to other shards may land during the iteration.
+    template<typename F>
+        requires Invocable<F, const K&, const V&>
+    void for_each(F&& f) const noexcept {
+        for(const Shard& shard : shards_) {
+            Thread::Shared_Lock lock(shard.lock);
+            for(const Pair<K, V>& entry : shard.map) {
+                f(entry.first, entry.second);
+            }
+        }
+    }
+
+    // Copies every entry out of the map, with the same consistency as for_each.
+    template<Allocator B = A>
+    [[nodiscard]] Vec<Pair<K, V>, B> snapshot() const noexcept
+        requires(Clone<K> || Copy_Constructable<K>) && (Clone<V> || Copy_Constructable<V>)
+    {
+        Vec<Pair<K, V>, B> entries;
+        for(const Shard& shard : shards_) {
+            Thread::Shared_Lock lock(shard.lock);
+            entries.reserve(entries.length() + shard.map.length());
+            for(const Pair<K, V>& entry : shard.map) {
+                entries.push(Pair<K, V>{copy(entry.first), copy(entry.second)});
+            }
+        }
+        return entries;
+    }
+
+    [[nodiscard]] constexpr static u64 shards() noexcept {
+        return S;
+    }
+
+private:
+    struct alignas(64) Shard {
+        mutable Thread::Shared_Mutex lock;
+        Map<K, V, A> map;
+    };
+
+    template<typename T>
+    [[nodiscard]] static T copy(const T& value) noexcept {
+        if constexpr(Clone<T>) {
+            return value.clone();
+        } else {
+            return T{value};
+        }
+    }
+
+    // Each shard's map indexes by the high bits of the hash, so shards are chosen by the low
+    // bits to keep keys spread within a shard.
+    [[nodiscard]] Shard& shard_for(const K& key) noexcept {
+        return shards_[hash(key) & (S - 1)];
+    }
+    [[nodiscard]] const Shard& shard_for(const K& key) const noexcept {
+        return shards_[hash(key) & (S - 1)];
+    }
+
+    Shard shards_[S];
+};
+
+} // namespace rpp
@@ -11,6 +11,7 @@ using File_Time = u64;
 
 [[nodiscard]] Opt<Vec<u8, Alloc>> read(String_View path) noexcept;
 [[nodiscard]] bool write(String_View path, Slice<const u8> data) noexcept;
+[[nodiscard]] bool remove(String_View path) noexcept;
 
 [[nodiscard]] Opt<File_Time> last_write_time(String_View path) noexcept;
 
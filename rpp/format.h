@@ -29,6 +29,99 @@ template<Allocator A, Reflectable T>
     }
 }
 
+namespace detail {
+
+constexpr char DIGIT_PAIRS[] = "00010203040506070809"
+                               "10111213141516171819"
+                               "20212223242526272829"
+                               "30313233343536373839"
+                               "40414243444546474849"
+                               "50515253545556575859"
+                               "60616263646566676869"
+                               "70717273747576777879"
+                               "80818283848586878889"
+                               "90919293949596979899";
+
+constexpr u64 FIXED_PRECISION = 6;
+constexpr u64 FIXED_SCALE = 1000000;
+
+[[nodiscard]] constexpr u64 count_digits(u64 value) noexcept {
+    u64 digits = 1;
+    for(;;) {
+        if(value < 10) return digits;
+        if(value < 100) return digits + 1;
+        if(value < 1000) return digits + 2;
+        if(value < 10000) return digits + 3;
+        value /= 10000;
+        digits += 4;
+    }
+}
+
+// Writes exactly count digits of value ending at out + count, padding with zeros.
+constexpr void write_digits(u8* out, u64 value, u64 count) noexcept {
+    while(count >= 2) {
+        u64 pair = (value % 100) * 2;
+        value /= 100;
+        out[--count] = static_cast<u8>(DIGIT_PAIRS[pair + 1]);
+        out[--count] = static_cast<u8>(DIGIT_PAIRS[pair]);
+    }
+    if(count) out[0] = static_cast<u8>('0' + value % 10);
+}
+
+template<Int I>
+[[nodiscard]] constexpr bool negative(I value) noexcept {
+    if constexpr(Signed_Int<I>) return value < 0;
+    return false;
+}
+
+template<Int I>
+[[nodiscard]] constexpr u64 magnitude(I value) noexcept {
+    if(negative(value)) return u64{0} - static_cast<u64>(value);
+    return static_cast<u64>(value);
+}
+
+template<Int I>
+[[nodiscard]] constexpr u64 measure_integer(I value) noexcept {
+    return count_digits(magnitude(value)) + (negative(value) ? 1 : 0);
+}
+
+template<Allocator A, Int I>
+[[nodiscard]] u64 write_integer(String<A>& output, u64 idx, I value) noexcept {
+    if(negative(value)) idx = output.write(idx, '-');
+    u64 digits = count_digits(magnitude(value));
+    assert(idx + digits <= output.length());
+    write_digits(output.data() + idx, magnitude(value), digits);
+    return idx + digits;
+}
+
+// A float rounded to FIXED_PRECISION decimals, matching printf's %f. Values that
+// are not finite or do not fit in a u64 are not exact and fall back to snprintf.
+struct Fixed {
+    u64 integer = 0;
+    u64 fraction = 0;
+    bool negative = false;
+    bool exact = false;
+};
+
+[[nodiscard]] Fixed fixed(f64 value) noexcept;
+
+[[nodiscard]] inline u64 measure_fixed(const Fixed& value) noexcept {
+    return (value.negative ? 1 : 0) + count_digits(value.integer) + 1 + FIXED_PRECISION;
+}
+
+template<Allocator A>
+[[nodiscard]] u64 write_fixed(String<A>& output, u64 idx, const Fixed& value) noexcept {
+    if(value.negative) idx = output.write(idx, '-');
+    u64 digits = count_digits(value.integer);
+    assert(idx + digits + 1 + FIXED_PRECISION <= output.length());
+    write_digits(output.data() + idx, value.integer, digits);
+    idx = output.write(idx + digits, '.');
+    write_digits(output.data() + idx, value.fraction, FIXED_PRECISION);
+    return idx + FIXED_PRECISION;
+}
+
+} // namespace detail
+
 template<u64 N>
 struct Record_Length {
     template<Reflectable T>
@@ -67,32 +160,15 @@ struct Measure {
             return 4;
         } else if constexpr(R::kind == Kind::char_) {
             return 1;
-        } else if constexpr(R::kind == Kind::i8_) {
-            return Libc::snprintf(null, 0, "%hhd", value);
-        } else if constexpr(R::kind == Kind::i16_) {
-            return Libc::snprintf(null, 0, "%hd", value);
-        } else if constexpr(R::kind == Kind::i32_) {
-            return Libc::snprintf(null, 0, "%d", value);
-        } else if constexpr(R::kind == Kind::i64_) {
-#ifdef RPP_COMPILER_MSVC
-            return Libc::snprintf(null, 0, "%lld", value);
-#else
-            return Libc::snprintf(null, 0, "%ld", value);
-#endif
-        } else if constexpr(R::kind == Kind::u8_) {
-            return Libc::snprintf(null, 0, "%hhu", value);
-        } else if constexpr(R::kind == Kind::u16_) {
-            return Libc::snprintf(null, 0, "%hu", value);
-        } else if constexpr(R::kind == Kind::u32_) {
-            return Libc::snprintf(null, 0, "%u", value);
-        } else if constexpr(R::kind == Kind::u64_) {
-#ifdef RPP_COMPILER_MSVC
-            return Libc::snprintf(null, 0, "%llu", value);
-#else
-            return Libc::snprintf(null, 0, "%lu", value);
-#endif
+        } else if constexpr(R::kind == Kind::i8_ || R::kind == Kind::i16_ ||
+                            R::kind == Kind::i32_ || R::kind == Kind::i64_ ||
+                            R::kind == Kind::u8_ || R::kind == Kind::u16_ ||
+                            R::kind == Kind::u32_ || R::kind == Kind::u64_) {
+            return detail::measure_integer(value);
         } else if constexpr(R::kind == Kind::f32_ || R::kind == Kind::f64_) {
-            return Libc::snprintf(null, 0, "%f", value);
+            detail::Fixed fixed = detail::fixed(static_cast<f64>(value));
+            if(fixed.exact) return detail::measure_fixed(fixed);
+            return Libc::snprintf(null, 0, "%f", static_cast<f64>(value));
         } else if constexpr(R::kind == Kind::bool_) {
             return value ? 4 : 5;
         } else if constexpr(R::kind == Kind::array_) {
@@ -131,32 +207,15 @@ struct Write {
             return output.write(idx, "void"_v);
         } else if constexpr(R::kind == Kind::char_) {
             return output.write(idx, value);
-        } else if constexpr(R::kind == Kind::i8_) {
-            return snprintf(output, idx, "%hhd", value);
-        } else if constexpr(R::kind == Kind::i16_) {
-            return snprintf(output, idx, "%hd", value);
-        } else if constexpr(R::kind == Kind::i32_) {
-            return snprintf(output, idx, "%d", value);
-        } else if constexpr(R::kind == Kind::i64_) {
-#ifdef RPP_COMPILER_MSVC
-            return snprintf(output, idx, "%lld", value);
-#else
-            return snprintf(output, idx, "%ld", value);
-#endif
-        } else if constexpr(R::kind == Kind::u8_) {
-            return snprintf(output, idx, "%hhu", value);
-        } else if constexpr(R::kind == Kind::u16_) {
-            return snprintf(output, idx, "%hu", value);
-        } else if constexpr(R::kind == Kind::u32_) {
-            return snprintf(output, idx, "%u", value);
-        } else if constexpr(R::kind == Kind::u64_) {
-#ifdef RPP_COMPILER_MSVC
-            return snprintf(output, idx, "%llu", value);
-#else
-            return snprintf(output, idx, "%lu", value);
-#endif
+        } else if constexpr(R::kind == Kind::i8_ || R::kind == Kind::i16_ ||
+                            R::kind == Kind::i32_ || R::kind == Kind::i64_ ||
+                            R::kind == Kind::u8_ || R::kind == Kind::u16_ ||
+                            R::kind == Kind::u32_ || R::kind == Kind::u64_) {
+            return detail::write_integer(output, idx, value);
         } else if constexpr(R::kind == Kind::f32_ || R::kind == Kind::f64_) {
-            return snprintf(output, idx, "%f", value);
+            detail::Fixed fixed = detail::fixed(static_cast<f64>(value));
+            if(fixed.exact) return detail::write_fixed(output, idx, fixed);
+            return snprintf(output, idx, "%f", static_cast<f64>(value));
         } else if constexpr(R::kind == Kind::bool_) {
             return value ? output.write(idx, "true"_v) : output.write(idx, "false"_v);
         } else if constexpr(R::kind == Kind::array_) {
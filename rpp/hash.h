@@ -34,6 +34,96 @@ namespace Hash {
     return squirrel5(h1 + h2);
 }
 
+namespace detail {
+
+// Word-at-a-time byte hash following the structure of wyhash: 16 or 48 bytes are consumed
+// per step, each pair of words being folded by a 64x64->128 bit multiply.
+
+constexpr u64 P0 = 0xa0761d6478bd642full;
+constexpr u64 P1 = 0xe7037ed1a0b428dbull;
+constexpr u64 P2 = 0x8ebc6af09c88c6e3ull;
+constexpr u64 P3 = 0x589965cc75374cc3ull;
+
+[[nodiscard]] constexpr u64 mix(u64 a, u64 b) noexcept {
+#ifdef RPP_COMPILER_MSVC
+    u64 lo_lo = (a & 0xffffffff) * (b & 0xffffffff);
+    u64 hi_lo = (a >> 32) * (b & 0xffffffff);
+    u64 lo_hi = (a & 0xffffffff) * (b >> 32);
+    u64 hi_hi = (a >> 32) * (b >> 32);
+    u64 cross = (lo_lo >> 32) + (hi_lo & 0xffffffff) + lo_hi;
+    u64 hi = hi_hi + (hi_lo >> 32) + (cross >> 32);
+    u64 lo = (cross << 32) | (lo_lo & 0xffffffff);
+    return lo ^ hi;
+#else
+    unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+    return static_cast<u64>(r) ^ static_cast<u64>(r >> 64);
+#endif
+}
+
+// Little-endian load of N bytes. Constant evaluation can't reinterpret memory, so it
+// assembles the word byte by byte.
+template<u64 N, typename C>
+[[nodiscard]] constexpr u64 read(const C* data) noexcept {
+    static_assert(N == 4 || N == 8);
+    if(is_constexpr()) {
+        u64 word = 0;
+        for(u64 i = 0; i < N; i++) word |= static_cast<u64>(static_cast<u8>(data[i])) << (8 * i);
+        return word;
+    }
+    using W = If<N == 8, u64, u32>;
+#ifdef RPP_COMPILER_MSVC
+    return *reinterpret_cast<const W*>(data);
+#else
+    W word;
+    __builtin_memcpy(&word, data, N);
+    return word;
+#endif
+}
+
+template<typename C>
+[[nodiscard]] constexpr u64 hash_bytes(const C* data, u64 length, u64 seed) noexcept {
+    seed ^= mix(seed ^ P0, P1);
+    u64 a = 0, b = 0;
+    if(length <= 16) {
+        if(length >= 4) {
+            u64 mid = (length >> 3) << 2;
+            a = (read<4>(data) << 32) | read<4>(data + mid);
+            b = (read<4>(data + length - 4) << 32) | read<4>(data + length - 4 - mid);
+        } else if(length > 0) {
+            a = (static_cast<u64>(static_cast<u8>(data[0])) << 16) |
+                (static_cast<u64>(static_cast<u8>(data[length >> 1])) << 8) |
+                static_cast<u64>(static_cast<u8>(data[length - 1]));
+        }
+    } else {
+        u64 i = length;
+        if(i > 48) {
+            u64 seed1 = seed, seed2 = seed;
+            do {
+                seed = mix(read<8>(data) ^ P1, read<8>(data + 8) ^ seed);
+                seed1 = mix(read<8>(data + 16) ^ P2, read<8>(data + 24) ^ seed1);
+                seed2 = mix(read<8>(data + 32) ^ P3, read<8>(data + 40) ^ seed2);
+                data += 48;
+                i -= 48;
+            } while(i > 48);
+            seed ^= seed1 ^ seed2;
+        }
+        while(i > 16) {
+            seed = mix(read<8>(data) ^ P1, read<8>(data + 8) ^ seed);
+            data += 16;
+            i -= 16;
+        }
+        a = read<8>(data + i - 16);
+        b = read<8>(data + i - 8);
+    }
+    return mix(P1 ^ length, mix(a ^ P1, b ^ seed));
+}
+
+} // namespace detail
+
+[[nodiscard]] constexpr u64 hash_bytes(const u8* data, u64 length, u64 seed = 0) noexcept {
+    return detail::hash_bytes(data, length, seed);
+}
+
 template<typename K>
 struct Hash;
 
@@ -72,6 +162,48 @@ struct Hash<T*> {
     }
 };
 
+namespace detail {
+
+template<typename T>
+[[nodiscard]] consteval bool trivially_hashable() noexcept;
+
+struct Is_Trivially_Hashable_Field {
+    template<typename F>
+    constexpr static bool value = trivially_hashable<typename F::type>();
+};
+
+// Records without padding whose fields are all integers, enums, or such records compare
+// equal exactly when their bytes do.
+template<typename T>
+[[nodiscard]] consteval bool trivially_hashable() noexcept {
+    if constexpr(requires { Reflect::Refl<T>::kind; }) {
+        constexpr Reflect::Kind kind = Reflect::Refl<T>::kind;
+        if constexpr(kind == Reflect::Kind::record_) {
+            return __has_unique_object_representations(T) &&
+                   Reflect::All<Is_Trivially_Hashable_Field, typename Reflect::Refl<T>::members>;
+        } else {
+            return kind != Reflect::Kind::void_ && kind != Reflect::Kind::f32_ &&
+                   kind != Reflect::Kind::f64_ && kind != Reflect::Kind::array_ &&
+                   kind != Reflect::Kind::pointer_;
+        }
+    } else {
+        return false;
+    }
+}
+
+} // namespace detail
+
+template<typename T>
+concept Trivially_Hashable = __is_class(T) && detail::trivially_hashable<T>();
+
+template<typename T>
+    requires Trivially_Hashable<T>
+struct Hash<T> {
+    [[nodiscard]] static u64 hash(const T& key) noexcept {
+        return hash_bytes(reinterpret_cast<const u8*>(&key), sizeof(T));
+    }
+};
+
 } // namespace Hash
 
 template<typename K>
@@ -96,9 +228,7 @@ template<Hashable... Ts>
 
 template<size_t N>
 [[nodiscard]] consteval u64 hash_literal(const char (&literal)[N], u64 seed = 0) noexcept {
-    for(size_t i = 0; i < N - 1; i++) {
-        seed = Hash::hash_combine(seed, hash(literal[i]));
-    }
+    seed = Hash::detail::hash_bytes(literal, N - 1, seed);
     return seed ? seed : 1;
 }
 
@@ -20,7 +20,7 @@ struct Heap {
     Heap() noexcept = default;
 
     explicit Heap(u64 capacity) noexcept {
-        data_ = reinterpret_cast<T*>(A::alloc(capacity * sizeof(T)));
+        data_ = reinterpret_cast<T*>(A::alloc(capacity * sizeof(T), alignof(T)));
         length_ = 0;
         capacity_ = capacity;
     }
@@ -71,7 +71,7 @@ struct Heap {
         requires(Clone<T> || Copy_Constructable<T>)
     {
         Heap<T, B> ret;
-        ret.data_ = reinterpret_cast<T*>(B::alloc(capacity_ * sizeof(T)));
+        ret.data_ = reinterpret_cast<T*>(B::alloc(capacity_ * sizeof(T), alignof(T)));
         ret.length_ = length_;
         ret.capacity_ = capacity_;
         if constexpr(Trivially_Copyable<T>) {
@@ -94,7 +94,14 @@ struct Heap {
     {
         if(new_capacity <= capacity_) return;
 
-        T* new_data = reinterpret_cast<T*>(A::alloc(new_capacity * sizeof(T)));
+        if constexpr(Reallocator<A> && Trivially_Movable<T>) {
+            data_ = reinterpret_cast<T*>(A::realloc(data_, capacity_ * sizeof(T),
+                                                    new_capacity * sizeof(T), alignof(T)));
+            capacity_ = new_capacity;
+            return;
+        }
+
+        T* new_data = reinterpret_cast<T*>(A::alloc(new_capacity * sizeof(T), alignof(T)));
         if constexpr(Trivially_Movable<T>) {
             Libc::memcpy(new_data, data_, length_ * sizeof(T));
         } else {
@@ -4,9 +4,14 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#ifdef RPP_OS_WINDOWS
+#include <malloc.h>
+#endif
+
 namespace rpp {
 
 static Thread::Atomic g_net_allocs;
+static thread_local u64 g_thread_allocs = 0;
 
 using Regions = Mallocator<"Regions", false>;
 
@@ -19,6 +24,7 @@ static_assert(sizeof(Chunk) == 24);
 
 constexpr u64 FIRST_CHUNK_SIZE = Math::KB(1);
 constexpr u64 MAX_REGION_DEPTH = 128;
+constexpr u64 COMMIT_GRANULARITY = Math::KB(64);
 
 struct First_Chunk {
     Chunk chunk = {null, FIRST_CHUNK_SIZE - sizeof(Chunk), 0};
@@ -32,6 +38,29 @@ thread_local Region region_brands[MAX_REGION_DEPTH] = {};
 thread_local First_Chunk first_chunk;
 thread_local Chunk* chunks = &first_chunk.chunk;
 
+struct Reservation {
+    u8* base = null;
+    u64 size = 0;
+    u64 committed = 0;
+    u64 dirty = 0;
+    bool discard = false;
+
+    ~Reservation() noexcept {
+        if(base) sys_release(base, size);
+    }
+};
+
+thread_local Reservation reservation;
+
+static void commit_to(u64 offset) noexcept {
+    if(offset > reservation.size) {
+        die("Region reservation of % bytes exhausted!", reservation.size);
+    }
+    u64 target = Math::min(Math::align_pow2(offset, COMMIT_GRANULARITY), reservation.size);
+    sys_commit(reservation.base + reservation.committed, target - reservation.committed);
+    reservation.committed = target;
+}
+
 static void new_chunk(u64 request) noexcept {
     u64 size = Math::max(request + sizeof(Chunk), 2 * (chunks->size + sizeof(Chunk)));
     Chunk* chunk = reinterpret_cast<Chunk*>(Regions::alloc(size));
@@ -41,20 +70,73 @@ static void new_chunk(u64 request) noexcept {
     chunks = chunk;
 }
 
+[[nodiscard]] static u64 chunk_padding(u64 align) noexcept {
+    uptr next = reinterpret_cast<uptr>(chunks) + sizeof(Chunk) + chunks->used;
+    return Math::align_pow2(next, align) - next;
+}
+
 static void assert_brand(Region brand) noexcept {
     if(region_brands[current_region] != brand) {
         die("Region brand mismatch!");
     }
 }
 
-[[nodiscard]] void* Region_Allocator::alloc(Region brand, u64 size) noexcept {
+[[nodiscard]] void* Region_Allocator::alloc(Region brand, u64 size, u64 align) noexcept {
+    assert_brand(brand);
+    assert(align > 0 && (align & (align - 1)) == 0);
+    if(reservation.base) {
+        // The reservation is page aligned, so aligning the offset aligns the pointer.
+        u64 offset = Math::align_pow2(region_offsets[current_region], align);
+        if(offset + size > reservation.committed) {
+            commit_to(offset + size);
+        }
+        region_offsets[current_region] = offset + size;
+        return reservation.base + offset;
+    }
+    u64 padding = chunk_padding(align);
+    if(chunks->size - chunks->used < padding + size) {
+        new_chunk(size + align - 1);
+        padding = chunk_padding(align);
+    }
+    // Padding is counted as used so end() can release it along with the allocation.
+    u8* ret = reinterpret_cast<u8*>(chunks) + sizeof(Chunk) + chunks->used + padding;
+    chunks->used += padding + size;
+    region_offsets[current_region] += padding + size;
+    return ret;
+}
+
+[[nodiscard]] void* Region_Allocator::realloc(Region brand, void* mem, u64 old_size, u64 new_size,
+                                              u64 align) noexcept {
+    assert(current_region > 0);
     assert_brand(brand);
-    if(chunks->size - chunks->used < size) {
-        new_chunk(size);
+    if(mem && new_size <= old_size) return mem;
+
+    // Only the most recent allocation in the current region can grow in place.
+    u8* end = reinterpret_cast<u8*>(mem) + old_size;
+    u64 grow = new_size - old_size;
+    u64 region_size = region_offsets[current_region] - region_offsets[current_region - 1];
+    if(mem && old_size <= region_size) {
+        if(reservation.base) {
+            u64 offset = region_offsets[current_region];
+            if(end == reservation.base + offset) {
+                if(offset + grow > reservation.committed) {
+                    commit_to(offset + grow);
+                }
+                region_offsets[current_region] += grow;
+                return mem;
+            }
+        } else {
+            u8* top = reinterpret_cast<u8*>(chunks) + sizeof(Chunk) + chunks->used;
+            if(end == top && chunks->size - chunks->used >= grow) {
+                chunks->used += grow;
+                region_offsets[current_region] += grow;
+                return mem;
+            }
+        }
     }
-    u8* ret = reinterpret_cast<u8*>(chunks) + sizeof(Chunk) + chunks->used;
-    chunks->used += size;
-    region_offsets[current_region] += size;
+
+    void* ret = alloc(brand, new_size, align);
+    if(mem) Libc::memcpy(ret, mem, old_size);
     return ret;
 }
 
@@ -72,6 +154,20 @@ void Region_Allocator::begin(Region brand) noexcept {
 void Region_Allocator::end(Region brand) noexcept {
     assert(current_region > 0);
     assert_brand(brand);
+    if(reservation.base) {
+        // Only pages written since the last discard need to be handed back.
+        reservation.dirty = Math::max(reservation.dirty, region_offsets[current_region]);
+        current_region--;
+        if(reservation.discard && current_region == 0) {
+            u64 keep = Math::align_pow2(region_offsets[0], COMMIT_GRANULARITY);
+            u64 dirty = Math::align_pow2(reservation.dirty, COMMIT_GRANULARITY);
+            if(keep < dirty) {
+                sys_discard(reservation.base + keep, dirty - keep);
+            }
+            reservation.dirty = 0;
+        }
+        return;
+    }
     u64 end_offset = region_offsets[current_region];
     current_region--;
     u64 start_offset = region_offsets[current_region];
@@ -98,25 +194,76 @@ void Region_Allocator::end(Region brand) noexcept {
     return region_offsets[current_region];
 }
 
+void Region_Allocator::reserve(u64 size, bool discard) noexcept {
+    assert(current_region == 0 && region_offsets[0] == 0);
+    if(reservation.base) {
+        sys_release(reservation.base, reservation.size);
+    }
+    reservation = {};
+    if(size == 0) return;
+    reservation.size = Math::align_pow2(size, COMMIT_GRANULARITY);
+    reservation.base = reinterpret_cast<u8*>(sys_reserve(reservation.size));
+    reservation.discard = discard;
+}
+
 [[nodiscard]] void* sys_alloc(u64 sz) noexcept {
-    void* ret = malloc(sz);
+    return sys_alloc(sz, DEFAULT_ALIGNMENT);
+}
+
+[[nodiscard]] void* sys_alloc(u64 sz, u64 align) noexcept {
+    assert(align > 0 && (align & (align - 1)) == 0);
+#ifdef RPP_OS_WINDOWS
+    // The CRT can only free over-aligned memory with _aligned_free, so every allocation goes
+    // through _aligned_malloc.
+    void* ret = _aligned_malloc(sz, Math::max(align, DEFAULT_ALIGNMENT));
+#else
+    void* ret = null;
+    if(align <= DEFAULT_ALIGNMENT) {
+        ret = malloc(sz);
+    } else if(posix_memalign(&ret, align, sz) != 0) {
+        ret = null;
+    }
+#endif
     assert(ret);
+    g_thread_allocs++;
 #ifndef RPP_RELEASE_BUILD
     g_net_allocs.incr();
 #endif
     return ret;
 }
 
+[[nodiscard]] void* sys_realloc(void* mem, u64 sz) noexcept {
+#ifdef RPP_OS_WINDOWS
+    void* ret = _aligned_realloc(mem, sz, DEFAULT_ALIGNMENT);
+#else
+    void* ret = ::realloc(mem, sz);
+#endif
+    assert(ret);
+    g_thread_allocs++;
+#ifndef RPP_RELEASE_BUILD
+    if(!mem) g_net_allocs.incr();
+#endif
+    return ret;
+}
+
 void sys_free(void* mem) noexcept {
     if(!mem) return;
 #ifndef RPP_RELEASE_BUILD
     g_net_allocs.decr();
 #endif
+#ifdef RPP_OS_WINDOWS
+    _aligned_free(mem);
+#else
     free(mem);
+#endif
 }
 
 [[nodiscard]] i64 sys_net_allocs() noexcept {
     return g_net_allocs.load();
 }
 
+[[nodiscard]] u64 sys_thread_allocs() noexcept {
+    return g_thread_allocs;
+}
+
 } // namespace rpp
\ No newline at end of file
@@ -0,0 +1,73 @@
+
+#include "../base.h"
+
+namespace rpp::Format::detail {
+
+[[nodiscard]] Fixed fixed(f64 value) noexcept {
+    u64 bits = 0;
+    Libc::memcpy(&bits, &value, sizeof(bits));
+
+    Fixed result;
+    result.negative = (bits >> 63) != 0;
+
+    u64 biased = (bits >> 52) & 0x7ff;
+    u64 mantissa = bits & ((u64{1} << 52) - 1);
+
+    // Infinities, NaNs, and values with more than 64 integer bits.
+    if(biased >= 1023 + 64) return result;
+    result.exact = true;
+
+    if(biased == 0 && mantissa == 0) return result;
+
+    i64 exponent = biased == 0 ? -1074 : static_cast<i64>(biased) - 1075;
+    if(biased != 0) mantissa |= u64{1} << 52;
+
+    if(exponent >= 0) {
+        result.integer = mantissa << exponent;
+        return result;
+    }
+
+    // value = mantissa / 2^shift. Past 74 bits, value * 10^6 < 2^73 / 2^75 rounds to zero.
+    u64 shift = static_cast<u64>(-exponent);
+    if(shift > 74) return result;
+
+    u64 remainder = mantissa;
+    if(shift < 64) {
+        result.integer = mantissa >> shift;
+        remainder = mantissa & ((u64{1} << shift) - 1);
+    }
+
+    // 128-bit remainder * 10^6 as hi:lo.
+    u64 high_product = (remainder >> 32) * FIXED_SCALE;
+    u64 low_product = (remainder & 0xffffffff) * FIXED_SCALE;
+    u64 lo = low_product + (high_product << 32);
+    u64 hi = (high_product >> 32) + (lo < low_product ? 1 : 0);
+
+    // Divide by 2^shift, rounding half to even like printf.
+    u64 quotient = 0;
+    bool half = false;
+    bool above = false;
+    if(shift < 64) {
+        quotient = (lo >> shift) | (hi << (64 - shift));
+        half = ((lo >> (shift - 1)) & 1) != 0;
+        above = (lo & ((u64{1} << (shift - 1)) - 1)) != 0;
+    } else if(shift == 64) {
+        quotient = hi;
+        half = (lo >> 63) != 0;
+        above = (lo << 1) != 0;
+    } else {
+        quotient = hi >> (shift - 64);
+        half = ((hi >> (shift - 65)) & 1) != 0;
+        above = lo != 0 || (hi & ((u64{1} << (shift - 65)) - 1)) != 0;
+    }
+    if(half && (above || (quotient & 1))) quotient++;
+
+    if(quotient == FIXED_SCALE) {
+        quotient = 0;
+        result.integer++;
+    }
+    result.fraction = quotient;
+    return result;
+}
+
+} // namespace rpp::Format::detail
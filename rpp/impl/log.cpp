@@ -1,6 +1,7 @@
 
 #include "../base.h"
 #include "../log_callback.h"
+#include "../thread.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -20,6 +21,52 @@ namespace rpp {
 
 namespace Log {
 
+constexpr u64 WRITE_BATCH = 256;
+
+struct Record {
+    Thread::Atomic sequence;
+
+    Level level = Level::info;
+    Thread::Id thread = 0;
+    Time time = 0;
+    u64 indent = 0;
+    Location location;
+
+    // Message text, or packed arguments for render to format on the writer thread.
+    u64 length = 0;
+    u8* spill = null;
+    alignas(detail::RECORD_ALIGN) u8 text[detail::RECORD_BYTES];
+
+    String_View format;
+    detail::Render render = null;
+    String<Mhidden> rendered;
+
+    [[nodiscard]] String_View message() const noexcept {
+        if(render) return rendered.view();
+        return String_View{spill ? spill : text, length};
+    }
+};
+
+// Bounded multi-producer queue: a record at position p is free for the producer that claims p
+// when its sequence is p, and ready for the writer when its sequence is p + 1.
+struct Async_Ring {
+    Record* records = null;
+    u64 mask = 0;
+    Overflow overflow = Overflow::drop;
+
+    Thread::Atomic tail, written, dropped;
+    Thread::Atomic sleeping, waiting, shutdown;
+    u64 head = 0;
+
+    Thread::Mutex mutex;
+    Thread::Cond wake, drained;
+    Thread::OS_Thread writer = Thread::OS_Thread_Null;
+
+    [[nodiscard]] bool ready(u64 position) const noexcept {
+        return records[position & mask].sequence.load<u64>() == position + 1;
+    }
+};
+
 struct Static_Data {
     Token next = 1;
     Map<Token, Function<Callback>, Mhidden> callbacks;
@@ -27,6 +74,8 @@ struct Static_Data {
     Thread::Mutex lock;
     FILE* file = null;
 
+    Async_Ring* async = null;
+
     Static_Data() noexcept {
 #ifdef RPP_OS_WINDOWS
         if(fopen_s(&file, "debug.log", "w")) file = null;
@@ -35,6 +84,7 @@ struct Static_Data {
 #endif
     }
     ~Static_Data() noexcept {
+        stop_async();
         if(file) fclose(file);
         file = null;
     }
@@ -42,6 +92,7 @@ struct Static_Data {
 
 static Storage<Static_Data> g_log_data;
 static thread_local u64 g_log_indent = 0;
+static thread_local bool g_log_writer = false;
 
 namespace detail {
 
@@ -135,26 +186,273 @@ static_assert(alignof(::time_t) <= alignof(Time));
     return String_View{reinterpret_cast<const u8*>(buffer), static_cast<u64>(written)};
 }
 
-void output(Level level, const Location& loc, String_View msg) noexcept {
-
-    const char* level_str;
-    const char* format_str;
-
+[[nodiscard]] static const char* line_format(Level level, const char*& level_str) noexcept {
     switch(level) {
     case Level::info: {
         level_str = "info";
-        format_str = "%.*s [%s/%zu] [%.*s:%zu]: %*s%.*s\n";
-    } break;
+        return "%.*s [%s/%zu] [%.*s:%zu]: %*s%.*s\n";
+    }
     case Level::warn: {
         level_str = "warn";
-        format_str = "\033[0;31m%.*s [%s/%zu] [%.*s:%zu]: %*s%.*s\033[0m\n";
-    } break;
+        return "\033[0;31m%.*s [%s/%zu] [%.*s:%zu]: %*s%.*s\033[0m\n";
+    }
     case Level::fatal: {
         level_str = "fatal";
-        format_str = "\033[0;31m%.*s [%s/%zu] [%.*s:%zu]: %*s%.*s\033[0m\n";
-    } break;
+        return "\033[0;31m%.*s [%s/%zu] [%.*s:%zu]: %*s%.*s\033[0m\n";
+    }
     default: RPP_UNREACHABLE;
     }
+}
+
+static void append_line(Vec<u8, Mhidden>& batch, const Record& record) noexcept {
+
+    const char* level_str;
+    const char* format_str = line_format(record.level, level_str);
+
+    String_View time = sys_time_string(record.time);
+    String_View msg = record.message();
+    const Location& loc = record.location;
+
+    i32 length = snprintf(null, 0, format_str, time.length(), time.data(), level_str,
+                          record.thread, loc.file.length(), loc.file.data(), loc.line,
+                          record.indent * INDENT_SIZE, "", msg.length(), msg.data());
+    assert(length >= 0);
+
+    u64 start = batch.length();
+    u64 size = static_cast<u64>(length);
+    batch.resize(start + size + 1);
+    static_cast<void>(snprintf(reinterpret_cast<char*>(batch.data() + start), size + 1,
+                               format_str, time.length(), time.data(), level_str, record.thread,
+                               loc.file.length(), loc.file.data(), loc.line,
+                               record.indent * INDENT_SIZE, "", msg.length(), msg.data()));
+    batch.resize(start + size);
+}
+
+static void wake_writer(Async_Ring& ring) noexcept {
+    if(ring.sleeping.load()) {
+        Thread::Lock lock(ring.mutex);
+        ring.wake.signal();
+    }
+}
+
+[[nodiscard]] static Thread::OS_Thread_Ret writer(void* data) noexcept {
+
+    Async_Ring& ring = *static_cast<Async_Ring*>(data);
+    g_log_writer = true;
+
+    Vec<u8, Mhidden> batch;
+
+    for(;;) {
+        u64 end = ring.head;
+        while(end - ring.head < WRITE_BATCH && ring.ready(end)) end++;
+
+        if(end == ring.head) {
+            if(ring.shutdown.load()) break;
+            Thread::Lock lock(ring.mutex);
+            ring.sleeping.exchange(1);
+            while(!ring.ready(ring.head) && !ring.shutdown.load()) {
+                ring.wake.wait(ring.mutex);
+            }
+            ring.sleeping.exchange(0);
+            continue;
+        }
+
+        for(u64 i = ring.head; i < end; i++) {
+            Record& record = ring.records[i & ring.mask];
+            if(record.render) record.rendered = record.render(record.format, record.text);
+            append_line(batch, record);
+        }
+        {
+            Thread::Lock lock(g_log_data->lock);
+            fwrite(batch.data(), 1, batch.length(), stdout);
+            fflush(stdout);
+            if(g_log_data->file) {
+                fwrite(batch.data(), 1, batch.length(), g_log_data->file);
+                fflush(g_log_data->file);
+            }
+        }
+        batch.clear();
+
+        for(u64 i = ring.head; i < end; i++) {
+            Record& record = ring.records[i & ring.mask];
+            for(auto& [_, callback] : g_log_data->callbacks) {
+                callback(record.level, record.thread, record.time, record.location,
+                         record.message());
+            }
+            if(record.spill) Mhidden::free(record.spill);
+            record.spill = null;
+            record.render = null;
+            record.rendered = String<Mhidden>{};
+            record.sequence.exchange(static_cast<i64>(i + ring.mask + 1));
+        }
+
+        ring.head = end;
+        ring.written.exchange(static_cast<i64>(end));
+        if(ring.waiting.load()) {
+            Thread::Lock lock(ring.mutex);
+            ring.drained.broadcast();
+        }
+    }
+
+    return Thread::OS_Thread_Ret_Null;
+}
+
+[[nodiscard]] static Record* claim(Async_Ring& ring, u64& position) noexcept {
+
+    position = ring.tail.load<u64>();
+
+    for(;;) {
+        Record* record = &ring.records[position & ring.mask];
+        i64 diff = record->sequence.load() - static_cast<i64>(position);
+        if(diff == 0) {
+            i64 claim = static_cast<i64>(position);
+            if(ring.tail.compare_and_swap(claim, claim + 1) == claim) return record;
+        } else if(diff < 0) {
+            // Full: the writer must never wait on itself.
+            if(ring.overflow == Overflow::drop || g_log_writer) {
+                ring.dropped.incr();
+                return null;
+            }
+            Thread::Lock lock(ring.mutex);
+            ring.waiting.incr();
+            while(record->sequence.load() < static_cast<i64>(position)) {
+                ring.wake.signal();
+                ring.drained.wait(ring.mutex);
+            }
+            ring.waiting.decr();
+        }
+        position = ring.tail.load<u64>();
+    }
+}
+
+static void publish(Async_Ring& ring, Record& record, u64 position, Level level,
+                    const Location& loc) noexcept {
+    record.level = level;
+    record.thread = Thread::this_id();
+    record.time = sys_time();
+    record.indent = g_log_indent;
+    record.location = loc;
+    record.sequence.exchange(static_cast<i64>(position + 1));
+
+    wake_writer(ring);
+}
+
+static void push(Async_Ring& ring, Level level, const Location& loc, String_View msg) noexcept {
+
+    u64 position = 0;
+    Record* record = claim(ring, position);
+    if(!record) return;
+
+    record->length = msg.length();
+    if(msg.length() > detail::RECORD_BYTES) {
+        record->spill = reinterpret_cast<u8*>(Mhidden::alloc(msg.length(), alignof(u8)));
+        Libc::memcpy(record->spill, msg.data(), msg.length());
+    } else {
+        Libc::memcpy(record->text, msg.data(), msg.length());
+    }
+
+    publish(ring, *record, position, level, loc);
+}
+
+void start_async(u64 capacity, Overflow overflow) noexcept {
+    assert(!g_log_data->async);
+    assert(capacity >= 2);
+
+    capacity = Math::next_pow2(capacity);
+
+    Async_Ring* ring = Pool_Adaptor<Mhidden>::make<Async_Ring>();
+    ring->records =
+        reinterpret_cast<Record*>(Mhidden::alloc(capacity * sizeof(Record), alignof(Record)));
+    for(u64 i = 0; i < capacity; i++) {
+        new(&ring->records[i]) Record{};
+        ring->records[i].sequence.exchange(static_cast<i64>(i));
+    }
+    ring->mask = capacity - 1;
+    ring->overflow = overflow;
+    ring->writer = Thread::sys_start(&writer, ring);
+
+    g_log_data->async = ring;
+}
+
+void stop_async() noexcept {
+    Async_Ring* ring = g_log_data->async;
+    if(!ring) return;
+
+    flush();
+    {
+        Thread::Lock lock(ring->mutex);
+        ring->shutdown.exchange(1);
+        ring->wake.signal();
+    }
+    Thread::sys_join(ring->writer);
+
+    g_log_data->async = null;
+    for(u64 i = 0; i <= ring->mask; i++) {
+        ring->records[i].~Record();
+    }
+    Mhidden::free(ring->records);
+    Pool_Adaptor<Mhidden>::destroy(ring);
+}
+
+void flush() noexcept {
+    Async_Ring* ring = g_log_data->async;
+    if(!ring || g_log_writer) return;
+
+    u64 target = ring->tail.load<u64>();
+
+    Thread::Lock lock(ring->mutex);
+    ring->waiting.incr();
+    while(ring->written.load<u64>() < target) {
+        ring->wake.signal();
+        ring->drained.wait(ring->mutex);
+    }
+    ring->waiting.decr();
+}
+
+[[nodiscard]] u64 dropped() noexcept {
+    Async_Ring* ring = g_log_data->async;
+    return ring ? ring->dropped.load<u64>() : 0;
+}
+
+namespace detail {
+
+[[nodiscard]] bool deferring() noexcept {
+    return g_log_data->async != null;
+}
+
+void output_deferred(Level level, const Location& loc, String_View fmt, Render render,
+                     const u8* args, u64 size) noexcept {
+    assert(size <= RECORD_BYTES);
+
+    Async_Ring* ring = g_log_data->async;
+    assert(ring);
+
+    u64 position = 0;
+    Record* record = claim(*ring, position);
+    if(!record) return;
+
+    record->length = size;
+    record->format = fmt;
+    record->render = render;
+    Libc::memcpy(record->text, args, size);
+
+    publish(*ring, *record, position, level, loc);
+}
+
+} // namespace detail
+
+void output(Level level, const Location& loc, String_View msg) noexcept {
+
+    if(Async_Ring* ring = g_log_data->async) {
+        if(level != Level::fatal) {
+            push(*ring, level, loc, msg);
+            return;
+        }
+        flush();
+    }
+
+    const char* level_str;
+    const char* format_str = line_format(level, level_str);
 
     Thread::Id thread = Thread::this_id();
     ::time_t timer = ::time(null);
@@ -146,6 +146,24 @@ namespace rpp::Math {
 #endif
 }
 
+[[nodiscard]] u32 cttz(u32 val) noexcept {
+#ifdef RPP_COMPILER_MSVC
+    return _tzcnt_u32(val);
+#else
+    if(val == 0) return 32;
+    return __builtin_ctz(val);
+#endif
+}
+
+[[nodiscard]] u64 cttz(u64 val) noexcept {
+#ifdef RPP_COMPILER_MSVC
+    return _tzcnt_u64(val);
+#else
+    if(val == 0) return 64;
+    return __builtin_ctzll(val);
+#endif
+}
+
 [[nodiscard]] u32 log2(u32 val) noexcept {
     return 31u - ctlz(val);
 }
@@ -1,8 +1,52 @@
 
 #include "../base.h"
 
+#include <stdio.h>
+
 namespace rpp {
 
+static Thread::Mutex g_trace_lock;
+static FILE* g_trace_file = null;
+static bool g_trace_first = true;
+static u64 g_trace_generation = 0;
+static Profile::Time_Point g_trace_begin = 0;
+
+static void append(Vec<u8, Mhidden>& out, String_View text) noexcept {
+    for(u8 c : text) out.push(c);
+}
+
+template<typename... Ts>
+static void append_format(Vec<u8, Mhidden>& out, const char* format, Ts... args) noexcept {
+    i32 length = snprintf(null, 0, format, args...);
+    assert(length >= 0);
+
+    u64 start = out.length();
+    u64 size = static_cast<u64>(length);
+    out.resize(start + size + 1);
+    static_cast<void>(
+        snprintf(reinterpret_cast<char*>(out.data() + start), size + 1, format, args...));
+    out.resize(start + size);
+}
+
+static void append_escaped(Vec<u8, Mhidden>& out, String_View text) noexcept {
+    for(u8 c : text) {
+        if(c == '"' || c == '\\') {
+            out.push('\\');
+            out.push(c);
+        } else if(c < 0x20) {
+            append_format(out, "\\u%04x", static_cast<u32>(c));
+        } else {
+            out.push(c);
+        }
+    }
+}
+
+// Microseconds since the trace started.
+[[nodiscard]] static f64 trace_time(Profile::Time_Point time) noexcept {
+    return static_cast<f64>(time - g_trace_begin) * 1000000.0 /
+           static_cast<f64>(Thread::perf_frequency());
+}
+
 [[nodiscard]] Profile::Time_Point Profile::timestamp() noexcept {
     return Thread::perf_counter();
 }
@@ -23,6 +67,8 @@ void Profile::register_thread() noexcept {
 
     this_thread.registered = true;
     this_thread.during_frame = false;
+    this_thread.id = id;
+    this_thread.events.reserve(EVENT_CAPACITY);
     threads.insert(id, Ref{this_thread});
 }
 
@@ -37,7 +83,8 @@ void Profile::unregister_thread() noexcept {
 
 [[nodiscard]] Profile::Time_Point Profile::Frame_Profile::begin() noexcept {
     assert(current_node == 0 && nodes.empty());
-    Timing_Node& node = nodes.push(Timing_Node::make(Log::Location{"Frame"_v, {}, 0}, 0));
+    Timing_Node& node = nodes.push(
+        Timing_Node::make(Log::Location{"Frame"_v, {}, 0}, RPP_UINT32_MAX, 0, timestamp()));
     return node.begin;
 }
 
@@ -66,6 +113,9 @@ f32 Profile::begin_frame() noexcept {
     Thread_Profile& prof = this_thread;
     Thread::Lock lock(prof.frames_lock);
 
+    // Events traced outside of a frame must not be folded into this one.
+    prof.replay();
+
     if(!prof.frames.empty() && prof.frames.full()) {
         prof.frames.pop();
     }
@@ -73,6 +123,7 @@ f32 Profile::begin_frame() noexcept {
     Frame_Profile& new_frame = prof.frames.emplace();
 
     Time_Point t = new_frame.begin();
+    prof.trace_frame(t, true);
 
     f32 ret = 0.0f;
     if(prof.frames.length() > 1) {
@@ -95,7 +146,13 @@ void Profile::end_frame() noexcept {
     assert(!prof.frames.empty());
 
     Frame_Profile& this_frame = prof.frames.back();
+    prof.replay();
     this_frame.end();
+    prof.trace_frame(this_frame.nodes.front().end, false);
+    {
+        Thread::Lock flush_lock(prof.trace_lock);
+        prof.flush_trace();
+    }
 
     prof.during_frame = false;
 }
@@ -103,105 +160,387 @@ void Profile::end_frame() noexcept {
 void Profile::enter(String_View name) noexcept {
     if constexpr(DO_PROFILE) {
         if(!this_thread.ready()) return;
-        enter(Log::Location{rpp::move(name), ""_v, 0});
+        this_thread.record(Event{timestamp(), this_thread.intern(name), true});
     }
 }
 
 void Profile::enter(Log::Location loc) noexcept {
     if constexpr(DO_PROFILE) {
         if(!this_thread.ready()) return;
-        Thread::Lock lock(this_thread.frames_lock);
-        this_thread.frames.back().enter(rpp::move(loc));
+        this_thread.record(Event{timestamp(), this_thread.intern(loc), true});
     }
 }
 
-void Profile::Frame_Profile::enter(Log::Location loc) noexcept {
+void Profile::exit() noexcept {
+    if constexpr(DO_PROFILE) {
+        if(!this_thread.ready()) return;
+        this_thread.record(Event{timestamp(), 0, false});
+    }
+}
 
-    bool repeat = false;
-    Timing_Node& node = nodes[current_node];
+// Only for locations made by RPP_HERE: the cache assumes equal addresses mean equal contents.
+[[nodiscard]] u32 Profile::Thread_Profile::intern(const Log::Location& loc) noexcept {
 
-    for(u64 child_idx : node.children) {
-        Timing_Node& child = nodes[child_idx];
-        if(child.loc == loc) {
-            current_node = child_idx;
-            repeat = true;
+    detail::Location_Key key{reinterpret_cast<uptr>(loc.function.data()), loc.function.length(),
+                             reinterpret_cast<uptr>(loc.file.data()), loc.file.length(),
+                             loc.line};
+
+    if(Opt<Ref<u32>> id = location_keys.try_get(key); id.ok()) {
+        return **id;
+    }
+
+    // Distinct literals with the same contents share a node.
+    u32 id = 0;
+    if(Opt<Ref<u32>> known = location_ids.try_get(loc); known.ok()) {
+        id = **known;
+    } else {
+        id = static_cast<u32>(locations.length());
+        {
+            Thread::Lock lock(trace_lock);
+            locations.push(Log::Location{loc});
+        }
+        location_ids.insert(loc, id);
+    }
+    location_keys.insert(rpp::move(key), id);
+    return id;
+}
+
+// Names may be built at runtime, so a hit in the address cache is confirmed against the stored
+// copy. Misses are looked up by contents, and new names are copied.
+[[nodiscard]] u32 Profile::Thread_Profile::intern(String_View name) noexcept {
+
+    detail::Location_Key key{reinterpret_cast<uptr>(name.data()), name.length()};
+
+    Opt<Ref<u32>> cached = name_keys.try_get(key);
+    if(cached.ok()) {
+        const Log::Location& known = locations[**cached];
+        if(Libc::memcmp(known.function.data(), name.data(), name.length()) == 0) {
+            return **cached;
         }
     }
 
-    if(!repeat) {
-        u64 child_idx = nodes.length();
-        node.children.push(child_idx);
-        nodes.push(Timing_Node::make(rpp::move(loc), current_node));
-        current_node = child_idx;
+    u32 id = 0;
+    if(Opt<Ref<u32>> known = location_ids.try_get(Log::Location{name, ""_v, 0}); known.ok()) {
+        id = **known;
     } else {
-        node.begin = timestamp();
-        node.calls++;
+        String<Mhidden>& copy = names.push(name.string<Mhidden>());
+        Log::Location loc{copy.view(), ""_v, 0};
+
+        id = static_cast<u32>(locations.length());
+        {
+            Thread::Lock lock(trace_lock);
+            locations.push(Log::Location{loc});
+        }
+        location_ids.insert(loc, id);
     }
+
+    if(cached.ok()) {
+        // The buffer has been reused for a different name.
+        **cached = id;
+    } else {
+        name_keys.insert(rpp::move(key), id);
+    }
+    return id;
 }
 
-void Profile::exit() noexcept {
-    if constexpr(DO_PROFILE) {
-        if(!this_thread.ready()) return;
-        Thread::Lock lock(this_thread.frames_lock);
-        this_thread.frames.back().exit();
+void Profile::Thread_Profile::record(Event event) noexcept {
+    if(events.length() == EVENT_CAPACITY) {
+        Thread::Lock lock(frames_lock);
+        replay();
     }
+    // The buffer never grows past its reservation, so stop_trace may read the published
+    // prefix while more events are pushed.
+    events.push(rpp::move(event));
+    Thread::store_release(published, events.length());
 }
 
-void Profile::Frame_Profile::exit() noexcept {
+// Requires frames_lock.
+void Profile::Thread_Profile::replay() noexcept {
+    Thread::Lock lock(trace_lock);
+    trace_events(events.length());
+    if(during_frame) {
+        assert(!frames.empty());
+        Frame_Profile& frame = frames.back();
+        for(const Event& event : events) {
+            if(event.enter) {
+                frame.enter(event.location, locations[event.location], event.time);
+            } else {
+                frame.exit(event.time);
+            }
+        }
+    }
+    events.clear();
+    Thread::store_relaxed(published, 0);
+    traced = 0;
+}
 
-    Frame_Profile& frame = this_thread.frames.back();
-    Timing_Node& node = frame.nodes[frame.current_node];
+// Writes out the first count events. Requires trace_lock. May run on any thread, so it must
+// not use this_thread.
+void Profile::Thread_Profile::trace_events(u64 count) noexcept {
+    if(trace_ready()) {
+        for(u64 i = traced; i < count; i++) {
+            const Event& event = events[i];
+            if(event.time < g_trace_begin) continue;
+            if(event.enter) {
+                const Log::Location& loc = locations[event.location];
+                append(trace, ",\n{\"name\":\""_v);
+                append_escaped(trace, loc.function);
+                append_format(trace,
+                              "\",\"cat\":\"scope\",\"ph\":\"B\",\"ts\":%.3f,\"pid\":0,\"tid\":%zu",
+                              trace_time(event.time), id);
+                if(!loc.file.empty()) {
+                    append(trace, ",\"args\":{\"file\":\""_v);
+                    append_escaped(trace, loc.file);
+                    append_format(trace, "\",\"line\":%zu}", loc.line);
+                }
+                append(trace, "}"_v);
+            } else {
+                append_format(trace, ",\n{\"ph\":\"E\",\"ts\":%.3f,\"pid\":0,\"tid\":%zu}",
+                              trace_time(event.time), id);
+            }
+        }
+        if(trace.length() >= TRACE_FLUSH) flush_trace();
+    }
+    traced = count;
+}
+
+[[nodiscard]] bool Profile::Thread_Profile::trace_ready() noexcept {
+    u64 generation = tracing.load<u64>();
+    if(generation != trace_generation) {
+        trace.clear();
+        trace_generation = generation;
+    }
+    return generation != 0;
+}
+
+void Profile::Thread_Profile::trace_frame(Time_Point time, bool enter) noexcept {
+    Thread::Lock lock(trace_lock);
+    if(!trace_ready() || time < g_trace_begin) return;
+    append_format(trace,
+                  ",\n{\"name\":\"Frame\",\"cat\":\"frame\",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":0,"
+                  "\"tid\":%zu}",
+                  enter ? "B" : "E", trace_time(time), id);
+}
+
+void Profile::Thread_Profile::trace_alloc(String_View name, i64 size) noexcept {
+    if(tracing.load() == 0) return;
+    Thread::Lock lock(trace_lock);
+    if(!trace_ready()) return;
+    Time_Point time = timestamp();
+    append(trace, ",\n{\"name\":\""_v);
+    append_escaped(trace, name);
+    append_format(trace,
+                  "\",\"cat\":\"alloc\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":0,"
+                  "\"args\":{\"bytes\":%lld}}",
+                  trace_time(time), static_cast<long long>(size));
+    if(trace.length() >= TRACE_FLUSH) flush_trace();
+}
+
+// Requires trace_lock.
+void Profile::Thread_Profile::flush_trace() noexcept {
+    if(trace.empty()) return;
+    {
+        Thread::Lock lock(g_trace_lock);
+        if(g_trace_file && trace_generation == g_trace_generation) {
+            // Every event is preceded by a separator, which the first one must drop.
+            u64 skip = g_trace_first ? 2 : 0;
+            fwrite(trace.data() + skip, 1, trace.length() - skip, g_trace_file);
+            g_trace_first = false;
+        }
+    }
+    trace.clear();
+}
 
-    node.end = timestamp();
+[[nodiscard]] bool Profile::start_trace(String_View path) noexcept {
+    Thread::Lock lock(g_trace_lock);
+
+    if(g_trace_file) {
+        warn("Profile: already tracing!");
+        return false;
+    }
+
+    String<Mhidden> terminated = path.terminate<Mhidden>();
+    const char* name = reinterpret_cast<const char*>(terminated.data());
+    FILE* file = null;
+#ifdef RPP_OS_WINDOWS
+    if(fopen_s(&file, name, "w")) file = null;
+#else
+    file = fopen(name, "w");
+#endif
+    if(!file) {
+        warn("Failed to open trace file %: %", path, Log::sys_error());
+        return false;
+    }
+
+    fputs("[\n", file);
+    g_trace_file = file;
+    g_trace_first = true;
+    g_trace_begin = timestamp();
+    tracing.exchange(static_cast<i64>(++g_trace_generation));
+    return true;
+}
+
+void Profile::stop_trace() noexcept {
+    {
+        // Threads outside of a frame may not replay their events until they exit.
+        Thread::Lock lock(threads_lock);
+        for(auto& entry : threads) {
+            Thread_Profile& thread = *entry.second;
+            Thread::Lock trace_lock(thread.trace_lock);
+            thread.trace_events(Thread::load_acquire(thread.published));
+            thread.flush_trace();
+        }
+    }
+
+    Thread::Lock lock(g_trace_lock);
+    if(!g_trace_file) return;
+
+    tracing.exchange(0);
+    fputs("\n]\n", g_trace_file);
+    fclose(g_trace_file);
+    g_trace_file = null;
+}
+
+void Profile::Frame_Profile::enter(u32 location, const Log::Location& loc,
+                                   Time_Point time) noexcept {
+
+    for(u64 child_idx : nodes[current_node].children) {
+        Timing_Node& child = nodes[child_idx];
+        if(child.location == location) {
+            child.begin = time;
+            child.calls++;
+            current_node = child_idx;
+            return;
+        }
+    }
+
+    u64 child_idx = nodes.length();
+    nodes[current_node].children.push(child_idx);
+    nodes.push(Timing_Node::make(loc, location, current_node, time));
+    current_node = child_idx;
+}
+
+void Profile::Frame_Profile::exit(Time_Point time) noexcept {
+
+    // Scopes entered before the frame began have no node.
+    if(current_node == 0) return;
+
+    Timing_Node& node = nodes[current_node];
+
+    node.end = time;
     node.heir_time += node.end - node.begin;
-    frame.current_node = node.parent;
+    current_node = node.parent;
+}
+
+[[nodiscard]] u32 Profile::register_allocator(String_View name) noexcept {
+    Thread::Lock lock(allocators_lock);
+
+    if(Opt<Ref<u32>> id = allocator_ids.try_get(name); id.ok()) {
+        return **id;
+    }
+    if(allocator_count == MAX_ALLOCATORS) {
+        die("Profile: more than % allocators!", MAX_ALLOCATORS);
+    }
+
+    u32 id = allocator_count++;
+    allocators[id].name = name;
+    allocator_ids.insert(name, id);
+    return id;
+}
+
+[[nodiscard]] i64 Profile::count(u32 allocator, i64 size) noexcept {
+
+    Alloc_Profile& prof = allocators[allocator];
+
+    i64 current = prof.current_size.add(size);
+    if(size > 0) {
+        i64 high = prof.high_water.load();
+        while(current > high) {
+            i64 seen = prof.high_water.compare_and_swap(high, current);
+            if(seen == high) break;
+            high = seen;
+        }
+    }
+
+    auto apply = [size](Alloc_Counters& counters) {
+        if(size > 0) {
+            counters.allocates++;
+            counters.allocate_size += size;
+        } else {
+            counters.frees++;
+            counters.free_size -= size;
+        }
+    };
+
+    if(alloc_shard_destroyed) {
+        Thread::Lock lock(allocators_lock);
+        apply(prof.totals);
+        return current;
+    }
+
+    Vec<Alloc_Counters, Mhidden>& counters = alloc_shard.counters;
+    if(allocator >= counters.length()) {
+        counters.resize(allocator + 1);
+    }
+    apply(counters[allocator]);
+    return current;
+}
+
+void Profile::merge(Alloc_Shard& shard) noexcept {
+    Thread::Lock lock(allocators_lock);
+    for(u64 i = 0; i < shard.counters.length(); i++) {
+        Alloc_Counters& from = shard.counters[i];
+        Alloc_Counters& to = allocators[i].totals;
+        to.allocates += from.allocates;
+        to.frees += from.frees;
+        to.allocate_size += from.allocate_size;
+        to.free_size += from.free_size;
+    }
+    shard.counters = {};
 }
 
 void Profile::alloc(Alloc a) noexcept {
     if constexpr(DO_PROFILE) {
+        if(a.allocator == UNKNOWN_ALLOCATOR) {
+            a.allocator = register_allocator(a.name);
+        }
+
+        Address_Shard& shard = addresses[rpp::hash(a.address) & (ADDRESS_SHARDS - 1)];
+
         bool replaced = false;
         bool no_entry = false;
+        i64 size = static_cast<i64>(a.size);
         {
-            Thread::Lock lock(allocs_lock);
-            Alloc_Profile& prof = allocs.get_or_insert(a.name);
+            Thread::Lock lock(shard.lock);
 
             if(a.size) {
-
-                if(prof.current_set.contains(a.address)) {
-                    replaced = true;
-                }
-                prof.current_set.insert(a.address, a.size);
-
-                prof.allocate_size += a.size;
-                prof.allocates++;
-                prof.current_set_size += a.size;
-                prof.high_water = Math::max(prof.high_water, prof.current_set_size);
-
+                replaced = shard.live.contains(a.address);
+                shard.live.insert(a.address, Live_Alloc{a.size, a.allocator});
             } else {
-
-                Opt<Ref<u64>> sz = prof.current_set.try_get(a.address);
-                if(!sz.ok()) {
+                Opt<Ref<Live_Alloc>> live = shard.live.try_get(a.address);
+                if(!live.ok() || (**live).allocator != a.allocator) {
                     no_entry = true;
                 } else {
-                    i64 size = **sz;
-                    prof.current_set.erase(a.address);
-                    prof.free_size += size;
-                    prof.frees++;
-                    prof.current_set_size -= size;
+                    size = -static_cast<i64>((**live).size);
+                    shard.live.erase(a.address);
                 }
             }
         }
 
+        if(!no_entry) {
+            i64 current = count(a.allocator, size);
+            if(!this_thread_destroyed) {
+                this_thread.trace_alloc(allocators[a.allocator].name, current);
+            }
+        }
+
         if(replaced) warn("Profile: % reallocated %!", a.name, a.address);
         if(no_entry) warn("Profile: % freed % with no entry!", a.name, a.address);
 
-        {
-            if(!this_thread_destroyed) {
-                Thread::Lock lock(this_thread.frames_lock);
-                if(this_thread.during_frame) {
-                    this_thread.frames.back().allocations.push(rpp::move(a));
-                }
-            }
+        // Only the owning thread changes during_frame, so it can be checked before locking.
+        if(!this_thread_destroyed && this_thread.during_frame) {
+            Thread::Lock lock(this_thread.frames_lock);
+            this_thread.frames.back().allocations.push(rpp::move(a));
         }
     }
 }
@@ -221,20 +560,27 @@ void Profile::finalize() noexcept {
         finalizers.~Vec();
     }
     this_thread.finalize();
+    stop_trace();
+    if(!alloc_shard_destroyed) merge(alloc_shard);
     {
-        Thread::Lock lock(allocs_lock);
-        for(auto& prof : allocs) {
-            info("Allocation stats for [%]:", prof.first);
-            info("\tAllocs: %", prof.second.allocates);
-            info("\tFrees: %", prof.second.frees);
-            info("\tHigh water: %", prof.second.high_water);
-            info("\tAlloc size: %", prof.second.allocate_size);
-            info("\tFree size: %", prof.second.free_size);
-            if(prof.second.current_set_size != 0) {
-                warn("\tUnbalanced size: %", prof.second.current_set_size);
+        Thread::Lock lock(allocators_lock);
+        for(u32 i = 0; i < allocator_count; i++) {
+            Alloc_Profile& prof = allocators[i];
+            info("Allocation stats for [%]:", prof.name);
+            info("\tAllocs: %", prof.totals.allocates);
+            info("\tFrees: %", prof.totals.frees);
+            info("\tHigh water: %", prof.high_water.load());
+            info("\tAlloc size: %", prof.totals.allocate_size);
+            info("\tFree size: %", prof.totals.free_size);
+            if(prof.current_size.load() != 0) {
+                warn("\tUnbalanced size: %", prof.current_size.load());
             }
         }
-        allocs.~Map();
+        allocator_ids = {};
+    }
+    for(Address_Shard& shard : addresses) {
+        Thread::Lock lock(shard.lock);
+        shard.live = {};
     }
     {
         Thread::Lock lock(threads_lock);
@@ -9,6 +9,8 @@ namespace rpp::SIMD {
 
 static_assert(sizeof(F32x4) == 16);
 static_assert(alignof(F32x4) == 16);
+static_assert(sizeof(U8x16) == 16);
+static_assert(alignof(U8x16) == 16);
 
 #ifdef RPP_COMPILER_MSVC
 
@@ -81,6 +83,28 @@ static_assert(alignof(F32x4) == 16);
     return _mm_movemask_ps(_mm_cmpeq_ps(of(a), of(b))) == 0xf;
 }
 
+[[nodiscard]] static __m128i of(U8x16 a) noexcept {
+    return _mm_load_si128(reinterpret_cast<const __m128i*>(a.data));
+}
+
+[[nodiscard]] static U8x16 to_u8(__m128i a) noexcept {
+    U8x16 ret;
+    _mm_store_si128(reinterpret_cast<__m128i*>(ret.data), a);
+    return ret;
+}
+
+[[nodiscard]] U8x16 U8x16::set1(u8 v) noexcept {
+    return to_u8(_mm_set1_epi8(static_cast<char>(v)));
+}
+
+[[nodiscard]] U8x16 U8x16::load(const u8* data) noexcept {
+    return to_u8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)));
+}
+
+[[nodiscard]] u32 U8x16::cmpeq_mask(U8x16 a, U8x16 b) noexcept {
+    return static_cast<u32>(_mm_movemask_epi8(_mm_cmpeq_epi8(of(a), of(b))));
+}
+
 #else
 
 [[nodiscard]] F32x4 F32x4::set(f32 x, f32 y, f32 z, f32 w) noexcept {
@@ -151,6 +175,22 @@ static_assert(alignof(F32x4) == 16);
     return __builtin_reduce_and(a.data == b.data) == -1;
 }
 
+[[nodiscard]] U8x16 U8x16::set1(u8 v) noexcept {
+    return {u8x16(v)};
+}
+
+[[nodiscard]] U8x16 U8x16::load(const u8* data) noexcept {
+    U8x16 ret;
+    __builtin_memcpy(&ret.data, data, sizeof(ret.data));
+    return ret;
+}
+
+[[nodiscard]] u32 U8x16::cmpeq_mask(U8x16 a, U8x16 b) noexcept {
+    // Converting to a vector of bools packs one bit per lane, like movemask.
+    using b16 = bool __attribute__((ext_vector_type(16)));
+    return __builtin_bit_cast(u16, __builtin_convertvector(a.data == b.data, b16));
+}
+
 #endif // RPP_COMPILER_MSVC
 
 } // namespace rpp::SIMD
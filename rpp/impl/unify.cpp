@@ -1,6 +1,7 @@
 
 #include "alloc.cpp"
 #include "base.cpp"
+#include "format.cpp"
 #include "log.cpp"
 #include "math.cpp"
 #include "profile.cpp"
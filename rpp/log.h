@@ -14,10 +14,10 @@
 #define RPP_HERE ::rpp::Log::Location::make(__FILE__, __LINE__, RPP_PRETTY_FUNCTION)
 
 #define info(fmt, ...)                                                                             \
-    (void)(::rpp::Log::log(::rpp::Log::Level::info, RPP_HERE, fmt##_v, ##__VA_ARGS__), 0)
+    (void)(::rpp::Log::log_literal(::rpp::Log::Level::info, RPP_HERE, fmt##_v, ##__VA_ARGS__), 0)
 
 #define warn(fmt, ...)                                                                             \
-    (void)(::rpp::Log::log(::rpp::Log::Level::warn, RPP_HERE, fmt##_v, ##__VA_ARGS__), 0)
+    (void)(::rpp::Log::log_literal(::rpp::Log::Level::warn, RPP_HERE, fmt##_v, ##__VA_ARGS__), 0)
 
 #define die(fmt, ...)                                                                              \
     (void)(::rpp::Log::log(::rpp::Log::Level::fatal, RPP_HERE, fmt##_v, ##__VA_ARGS__),            \
@@ -84,9 +84,27 @@ using Time = u64;
 [[nodiscard]] String_View sys_time_string(Time time) noexcept;
 [[nodiscard]] String_View sys_error() noexcept;
 
+enum class Overflow : u8 {
+    drop,
+    block,
+};
+
+constexpr u64 ASYNC_CAPACITY = 4096;
+
 void debug_break() noexcept;
 void output(Level level, const Location& loc, String_View msg) noexcept;
 
+// Queues messages for a background writer thread, which batches them into one write per output
+// and runs callbacks. When the queue is full, messages are dropped or the caller waits for space.
+// Fatal messages flush the queue and are written synchronously.
+void start_async(u64 capacity = ASYNC_CAPACITY, Overflow overflow = Overflow::drop) noexcept;
+// Writes all queued messages and returns to synchronous output.
+// Must not race with logging on other threads.
+void stop_async() noexcept;
+// Blocks until every message queued so far has been written.
+void flush() noexcept;
+[[nodiscard]] u64 dropped() noexcept;
+
 template<typename... Ts>
 void log(Level level, const Location& loc, String_View fmt, const Ts&... args) noexcept {
     Region(R) output(level, loc, format<Mregion<R>>(fmt, args...).view());
@@ -94,6 +112,98 @@ void log(Level level, const Location& loc, String_View fmt, const Ts&... args) n
 
 namespace detail {
 
+constexpr u64 RECORD_BYTES = 192;
+constexpr u64 RECORD_ALIGN = 16;
+
+using Render = String<Mhidden> (*)(String_View fmt, const u8* args) noexcept;
+
+[[nodiscard]] bool deferring() noexcept;
+void output_deferred(Level level, const Location& loc, String_View fmt, Render render,
+                     const u8* args, u64 size) noexcept;
+
+template<typename T>
+[[nodiscard]] consteval bool deferrable() noexcept;
+
+struct Is_Deferrable_Field {
+    template<typename F>
+    constexpr static bool value = deferrable<typename F::type>();
+};
+
+// Values that format the same from a copy of their bytes: trivially copyable and free of
+// pointers, which could dangle before the writer thread formats them.
+template<typename T>
+[[nodiscard]] consteval bool deferrable() noexcept {
+    if constexpr(requires { Reflect::Refl<T>::kind; }) {
+        constexpr Reflect::Kind kind = Reflect::Refl<T>::kind;
+        if constexpr(!__is_trivially_copyable(T) || alignof(T) > RECORD_ALIGN) {
+            return false;
+        } else if constexpr(kind == Reflect::Kind::record_) {
+            return Reflect::All<Is_Deferrable_Field, typename Reflect::Refl<T>::members>;
+        } else if constexpr(kind == Reflect::Kind::array_) {
+            return deferrable<typename Reflect::Refl<T>::underlying>();
+        } else {
+            return kind != Reflect::Kind::void_ && kind != Reflect::Kind::pointer_;
+        }
+    } else {
+        return false;
+    }
+}
+
+template<typename... Ts>
+struct Packed {
+    struct Layout {
+        u64 offsets[sizeof...(Ts) + 1] = {};
+    };
+
+    constexpr static Layout layout = []() {
+        Layout result;
+        u64 size = 0, i = 0;
+        ((size = Math::align_pow2(size, static_cast<u64>(alignof(Ts))),
+          result.offsets[i++] = size, size += sizeof(Ts)),
+         ...);
+        result.offsets[sizeof...(Ts)] = size;
+        return result;
+    }();
+
+    constexpr static u64 size = layout.offsets[sizeof...(Ts)];
+    constexpr static bool can_defer = (deferrable<Ts>() && ...) && size <= RECORD_BYTES;
+
+    static void pack(u8* bytes, const Ts&... args) noexcept {
+        u64 i = 0;
+        (Libc::memcpy(bytes + layout.offsets[i++], &args, sizeof(Ts)), ...);
+    }
+
+    [[nodiscard]] static String<Mhidden> render(String_View fmt, const u8* bytes) noexcept {
+        return render_at(fmt, bytes, Index_Sequence_For<Ts...>{});
+    }
+
+    template<u64... Is>
+    [[nodiscard]] static String<Mhidden> render_at(String_View fmt, const u8* bytes,
+                                                   Index_Sequence<Is...>) noexcept {
+        return format<Mhidden>(fmt, *reinterpret_cast<const Ts*>(bytes + layout.offsets[Is])...);
+    }
+};
+
+} // namespace detail
+
+// Used by info and warn: fmt must be a string literal. In async mode, when every argument is
+// deferrable, the arguments are copied into the queued record and formatted on the writer thread.
+template<typename... Ts>
+void log_literal(Level level, const Location& loc, String_View fmt, const Ts&... args) noexcept {
+    using Args = detail::Packed<Ts...>;
+    if constexpr(Args::can_defer) {
+        if(detail::deferring()) {
+            alignas(detail::RECORD_ALIGN) u8 bytes[Args::size + 1];
+            Args::pack(bytes, args...);
+            detail::output_deferred(level, loc, fmt, &Args::render, bytes, Args::size);
+            return;
+        }
+    }
+    log(level, loc, fmt, args...);
+}
+
+namespace detail {
+
 struct Static_Init {
     Static_Init() noexcept;
     ~Static_Init() noexcept;
@@ -107,6 +217,7 @@ inline Static_Init g_initializer;
 } // namespace Log
 
 RPP_NAMED_ENUM(Log::Level, "Level", info, RPP_CASE(info), RPP_CASE(warn), RPP_CASE(fatal));
+RPP_NAMED_ENUM(Log::Overflow, "Overflow", drop, RPP_CASE(drop), RPP_CASE(block));
 RPP_NAMED_RECORD(Log::Location, "Location", RPP_FIELD(function), RPP_FIELD(file), RPP_FIELD(line));
 
 namespace Hash {
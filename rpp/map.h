@@ -82,7 +82,7 @@ struct Map {
         shift_ = Math::ctlz(capacity_) + 1;
         usable_ = (capacity_ / 4) * 3;
         length_ = 0;
-        data_ = reinterpret_cast<Slot*>(A::alloc(capacity_ * sizeof(Slot)));
+        data_ = reinterpret_cast<Slot*>(A::alloc(capacity_ * sizeof(Slot), alignof(Slot)));
         Libc::memset(data_, 0, capacity_ * sizeof(Slot));
     }
 
@@ -159,7 +159,7 @@ struct Map {
         u64 old_capacity = capacity_;
 
         capacity_ = new_capacity;
-        data_ = reinterpret_cast<Slot*>(A::alloc(capacity_ * sizeof(Slot)));
+        data_ = reinterpret_cast<Slot*>(A::alloc(capacity_ * sizeof(Slot), alignof(Slot)));
         Libc::memset(data_, 0, capacity_ * sizeof(Slot));
         usable_ = (capacity_ / 4) * 3;
         shift_ = Math::ctlz(capacity_) + 1;
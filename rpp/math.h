@@ -112,6 +112,8 @@ template<Int I>
 [[nodiscard]] u64 popcount(u64 val) noexcept;
 [[nodiscard]] u32 ctlz(u32 val) noexcept;
 [[nodiscard]] u64 ctlz(u64 val) noexcept;
+[[nodiscard]] u32 cttz(u32 val) noexcept;
+[[nodiscard]] u64 cttz(u64 val) noexcept;
 [[nodiscard]] u32 log2(u32 val) noexcept;
 [[nodiscard]] u64 log2(u64 val) noexcept;
 [[nodiscard]] u32 prev_pow2(u32 val) noexcept;
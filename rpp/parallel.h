@@ -0,0 +1,325 @@
+
+#pragma once
+
+#include "base.h"
+#include "pool.h"
+
+namespace rpp::Async {
+
+// Data parallel algorithms split their input into chunks of at least grain elements. The
+// calling thread claims chunks alongside up to one helper task per pool worker, and returns
+// once every chunk has finished. Callbacks run concurrently and must not suspend.
+constexpr u64 DEFAULT_GRAIN = 1024;
+
+namespace detail {
+
+// Shared between the caller and its helpers. Helpers may start after all chunks have been
+// claimed, or after the caller has returned, so the last one out frees the state.
+template<Allocator A>
+struct Chunk_State {
+    Thread::Atomic next, done, refs;
+    u64 chunks = 0;
+    void* f = null;
+    void (*run)(void*, u64) = null;
+
+    void work() noexcept {
+        for(;;) {
+            u64 chunk = static_cast<u64>(next.incr() - 1);
+            if(chunk >= chunks) return;
+            run(f, chunk);
+            done.incr();
+        }
+    }
+
+    void release() noexcept {
+        if(refs.decr() == 0) {
+            this->~Chunk_State();
+            A::free(this);
+        }
+    }
+};
+
+// The release also runs if the pool shuts down and destroys the helper before it resumes.
+template<Allocator A>
+[[nodiscard]] Task<void, A> chunk_helper(Pool<A>& pool, Chunk_State<A>* state) noexcept {
+    struct Release {
+        Chunk_State<A>* state;
+        ~Release() noexcept {
+            state->release();
+        }
+    };
+    Release release{state};
+    co_await pool.suspend();
+    state->work();
+}
+
+// Calls f(chunk) for every chunk in [0, chunks).
+template<Allocator A, typename F>
+    requires Invocable<F, u64>
+void run_chunks(Pool<A>& pool, u64 chunks, F&& f) noexcept {
+    if(chunks == 0) return;
+
+    u64 helpers = Math::min(pool.n_threads(), chunks - 1);
+    if(helpers == 0) {
+        for(u64 i = 0; i < chunks; i++) f(i);
+        return;
+    }
+
+    using State = Chunk_State<A>;
+    State* state = reinterpret_cast<State*>(A::alloc(sizeof(State), alignof(State)));
+    new(state) State{};
+    state->chunks = chunks;
+    state->refs.exchange(static_cast<i64>(helpers + 1));
+    using Fn = decltype(&f);
+    state->f = &f;
+    state->run = [](void* fn, u64 chunk) { (*static_cast<Fn>(fn))(chunk); };
+
+    // Dropping the tasks detaches them.
+    for(u64 i = 0; i < helpers; i++) {
+        static_cast<void>(chunk_helper(pool, state));
+    }
+
+    state->work();
+    while(state->done.load() != static_cast<i64>(chunks)) {
+        Thread::pause();
+    }
+    state->release();
+}
+
+[[nodiscard]] inline u64 chunk_count(u64 length, u64 grain) noexcept {
+    grain = Math::max(grain, u64{1});
+    return (length + grain - 1) / grain;
+}
+
+template<typename T, typename L>
+void insertion_sort(T* data, u64 length, L& less) noexcept {
+    for(u64 i = 1; i < length; i++) {
+        T value = rpp::move(data[i]);
+        u64 j = i;
+        for(; j > 0 && less(value, data[j - 1]); j--) {
+            data[j] = rpp::move(data[j - 1]);
+        }
+        data[j] = rpp::move(value);
+    }
+}
+
+template<typename T, typename L>
+void sift_down(T* data, u64 root, u64 length, L& less) noexcept {
+    for(;;) {
+        u64 child = 2 * root + 1;
+        if(child >= length) return;
+        if(child + 1 < length && less(data[child], data[child + 1])) child++;
+        if(!less(data[root], data[child])) return;
+        swap(data[root], data[child]);
+        root = child;
+    }
+}
+
+template<typename T, typename L>
+void heap_sort(T* data, u64 length, L& less) noexcept {
+    for(u64 i = length / 2; i > 0; i--) sift_down(data, i - 1, length, less);
+    for(u64 end = length; end > 1; end--) {
+        swap(data[0], data[end - 1]);
+        sift_down(data, 0, end - 1, less);
+    }
+}
+
+// Introsort: quicksort with a median of three pivot, falling back to heap sort if the
+// recursion gets too deep and to insertion sort for short ranges.
+template<typename T, typename L>
+void sort(T* data, u64 length, L& less, u64 depth) noexcept {
+    constexpr u64 INSERTION_THRESHOLD = 16;
+
+    while(length > INSERTION_THRESHOLD) {
+        if(depth == 0) {
+            heap_sort(data, length, less);
+            return;
+        }
+        depth--;
+
+        u64 mid = length / 2;
+        if(less(data[mid], data[0])) swap(data[mid], data[0]);
+        if(less(data[length - 1], data[0])) swap(data[length - 1], data[0]);
+        if(less(data[length - 1], data[mid])) swap(data[length - 1], data[mid]);
+        swap(data[mid], data[length - 2]);
+        T& pivot = data[length - 2];
+
+        u64 i = 0, j = length - 2;
+        for(;;) {
+            while(less(data[++i], pivot)) {
+            }
+            while(less(pivot, data[--j])) {
+            }
+            if(i >= j) break;
+            swap(data[i], data[j]);
+        }
+        swap(data[i], data[length - 2]);
+
+        // Recurse into the smaller side to bound stack depth.
+        if(i < length - i - 1) {
+            sort(data, i, less, depth);
+            data += i + 1;
+            length -= i + 1;
+        } else {
+            sort(data + i + 1, length - i - 1, less, depth);
+            length = i;
+        }
+    }
+    insertion_sort(data, length, less);
+}
+
+template<typename T, typename L>
+void merge(T* left, u64 left_length, T* right, u64 right_length, T* out, L& less) noexcept {
+    u64 i = 0, j = 0, k = 0;
+    while(i < left_length && j < right_length) {
+        if(less(right[j], left[i])) {
+            out[k++] = rpp::move(right[j++]);
+        } else {
+            out[k++] = rpp::move(left[i++]);
+        }
+    }
+    while(i < left_length) out[k++] = rpp::move(left[i++]);
+    while(j < right_length) out[k++] = rpp::move(right[j++]);
+}
+
+} // namespace detail
+
+// Calls f(begin, end) for each chunk of the range [0, length).
+template<Allocator A, typename F>
+    requires Invocable<F, u64, u64>
+void parallel_for(Pool<A>& pool, u64 length, F&& f, u64 grain = DEFAULT_GRAIN) noexcept {
+    grain = Math::max(grain, u64{1});
+    detail::run_chunks(pool, detail::chunk_count(length, grain), [&](u64 chunk) {
+        u64 begin = chunk * grain;
+        f(begin, Math::min(begin + grain, length));
+    });
+}
+
+// Calls f on each element of data.
+template<typename T, Allocator A, typename F>
+    requires Invocable<F, T&>
+void parallel_for(Pool<A>& pool, Slice<T> data, F&& f, u64 grain = DEFAULT_GRAIN) noexcept {
+    parallel_for(
+        pool, data.length(),
+        [&](u64 begin, u64 end) {
+            for(u64 i = begin; i < end; i++) f(data[i]);
+        },
+        grain);
+}
+
+// Folds each chunk into a copy of identity with fold(R, const T&), then combines the chunk
+// results in order with combine(R, R). Both must be associative for the result to match a
+// sequential fold.
+template<typename T, typename R, Allocator A, typename F, typename C>
+    requires Copy_Constructable<R> && Invocable<F, R, const T&> && Invocable<C, R, R>
+[[nodiscard]] R parallel_reduce(Pool<A>& pool, Slice<T> data, R identity, F&& fold,
+                                C&& combine, u64 grain = DEFAULT_GRAIN) noexcept {
+    grain = Math::max(grain, u64{1});
+    u64 chunks = detail::chunk_count(data.length(), grain);
+
+    Vec<R, A> partials{chunks};
+    for(u64 i = 0; i < chunks; i++) partials.push(R{identity});
+
+    detail::run_chunks(pool, chunks, [&](u64 chunk) {
+        u64 begin = chunk * grain;
+        u64 end = Math::min(begin + grain, data.length());
+        R result = rpp::move(partials[chunk]);
+        for(u64 i = begin; i < end; i++) result = fold(rpp::move(result), data[i]);
+        partials[chunk] = rpp::move(result);
+    });
+
+    R result = rpp::move(identity);
+    for(R& partial : partials) result = combine(rpp::move(result), rpp::move(partial));
+    return result;
+}
+
+// Replaces each element with op applied to it and all prior elements (an inclusive scan).
+// Op must be associative; identity must satisfy op(identity, x) == x.
+template<typename T, Allocator A, typename F>
+    requires Copy_Constructable<T> && Invocable<F, T, const T&>
+void parallel_scan(Pool<A>& pool, Slice<T> data, T identity, F&& op,
+                   u64 grain = DEFAULT_GRAIN) noexcept {
+    grain = Math::max(grain, u64{1});
+    u64 chunks = detail::chunk_count(data.length(), grain);
+    if(chunks == 0) return;
+
+    // Scan each chunk, then offset every chunk by the total of the chunks before it.
+    Vec<T, A> totals{chunks};
+    for(u64 i = 0; i < chunks; i++) totals.push(T{identity});
+
+    detail::run_chunks(pool, chunks, [&](u64 chunk) {
+        u64 begin = chunk * grain;
+        u64 end = Math::min(begin + grain, data.length());
+        for(u64 i = begin + 1; i < end; i++) data[i] = op(T{data[i - 1]}, data[i]);
+        totals[chunk] = T{data[end - 1]};
+    });
+
+    T carry = rpp::move(identity);
+    for(T& total : totals) {
+        T next = op(T{carry}, total);
+        total = rpp::move(carry);
+        carry = rpp::move(next);
+    }
+
+    detail::run_chunks(pool, chunks - 1, [&](u64 chunk) {
+        chunk += 1;
+        u64 begin = chunk * grain;
+        u64 end = Math::min(begin + grain, data.length());
+        for(u64 i = begin; i < end; i++) data[i] = op(T{totals[chunk]}, data[i]);
+    });
+}
+
+// Sorts each chunk in parallel, then merges pairs of sorted runs until one remains. The sort
+// is not stable.
+template<typename T, Allocator A, typename L>
+    requires Default_Constructable<T> && Move_Constructable<T> &&
+             Invocable<L, const T&, const T&>
+void parallel_sort(Pool<A>& pool, Slice<T> data, L&& less, u64 grain = DEFAULT_GRAIN) noexcept {
+    u64 length = data.length();
+    if(length < 2) return;
+
+    // One run per participating thread, unless that would make runs shorter than grain.
+    u64 threads = pool.n_threads() + 1;
+    u64 run = Math::max(Math::max(grain, u64{1}), (length + threads - 1) / threads);
+    u64 runs = detail::chunk_count(length, run);
+
+    detail::run_chunks(pool, runs, [&](u64 chunk) {
+        u64 begin = chunk * run;
+        u64 end = Math::min(begin + run, length);
+        u64 depth = 2 * (64 - Math::ctlz(end - begin));
+        detail::sort(data.data() + begin, end - begin, less, depth);
+    });
+    if(runs == 1) return;
+
+    Vec<T, A> scratch = Vec<T, A>::make(length);
+    T* from = data.data();
+    T* to = scratch.data();
+
+    for(u64 width = run; width < length; width *= 2) {
+        u64 pairs = detail::chunk_count(length, 2 * width);
+        detail::run_chunks(pool, pairs, [&](u64 pair) {
+            u64 begin = pair * 2 * width;
+            u64 mid = Math::min(begin + width, length);
+            u64 end = Math::min(begin + 2 * width, length);
+            detail::merge(from + begin, mid - begin, from + mid, end - mid, to + begin, less);
+        });
+        swap(from, to);
+    }
+
+    if(from != data.data()) {
+        parallel_for(
+            pool, length,
+            [&](u64 begin, u64 end) {
+                for(u64 i = begin; i < end; i++) data[i] = rpp::move(from[i]);
+            },
+            grain);
+    }
+}
+
+template<typename T, Allocator A>
+    requires Ordered<T> && Default_Constructable<T> && Move_Constructable<T>
+void parallel_sort(Pool<A>& pool, Slice<T> data, u64 grain = DEFAULT_GRAIN) noexcept {
+    parallel_sort(pool, data, [](const T& l, const T& r) { return l < r; }, grain);
+}
+
+} // namespace rpp::Async
@@ -3,6 +3,8 @@
 
 #include "async.h"
 #include "base.h"
+#include "heap.h"
+#include "rng.h"
 #include "thread.h"
 
 namespace rpp::Async {
@@ -13,10 +15,11 @@ struct Pool;
 template<Allocator A = Alloc>
 struct Schedule {
 
-    explicit Schedule(Pool<A>& pool) noexcept : pool{pool} {
+    explicit Schedule(Pool<A>& pool, Thread::Priority priority) noexcept
+        : pool{pool}, priority{priority} {
     }
     void await_suspend(std::coroutine_handle<> task) noexcept {
-        pool.enqueue(Handle{task});
+        pool.enqueue(Handle{task}, priority);
     }
     void await_resume() noexcept {
     }
@@ -26,6 +29,7 @@ struct Schedule {
 
 private:
     Pool<A>& pool;
+    Thread::Priority priority;
 };
 
 template<Allocator A = Alloc>
@@ -48,8 +52,193 @@ private:
     Pool<A>& pool;
 };
 
+template<Allocator A = Alloc>
+struct Timer_Handle {
+
+    explicit Timer_Handle(Pool<A>& pool, u64 id) noexcept : pool{pool}, id{id} {
+    }
+
+    // Resumes the waiting task early, or makes it return immediately if it has not started
+    // waiting yet. Returns false if the timer already elapsed or was already canceled.
+    bool cancel() noexcept {
+        return pool.cancel_timer(id);
+    }
+
+private:
+    Pool<A>& pool;
+    u64 id;
+};
+
+template<Allocator A = Alloc>
+struct Schedule_Timer {
+
+    explicit Schedule_Timer(Pool<A>& pool, u64 ms) noexcept
+        : pool{pool}, id{pool.next_timer_id()},
+          deadline{Thread::perf_counter() + ms * Thread::perf_frequency() / 1000} {
+    }
+    // A timer that is still armed when destroyed, e.g. because its frame was destroyed while
+    // suspended, must not be fired.
+    ~Schedule_Timer() noexcept {
+        if(tracked || (armed && !fired && !canceled)) pool.forget_timer(*this);
+    }
+
+    // The pool refers to the timer by address.
+    Schedule_Timer(const Schedule_Timer&) noexcept = delete;
+    Schedule_Timer& operator=(const Schedule_Timer&) noexcept = delete;
+    Schedule_Timer(Schedule_Timer&&) noexcept = delete;
+    Schedule_Timer& operator=(Schedule_Timer&&) noexcept = delete;
+
+    bool await_suspend(std::coroutine_handle<> task) noexcept {
+        job = Handle{task};
+        return pool.enqueue_timer(*this);
+    }
+    // True if the timer elapsed, false if it was canceled.
+    bool await_resume() noexcept {
+        return !canceled;
+    }
+    [[nodiscard]] bool await_ready() noexcept {
+        return false;
+    }
+
+    [[nodiscard]] Timer_Handle<A> handle() noexcept {
+        pool.track_timer(*this);
+        return Timer_Handle<A>{pool, id};
+    }
+
+private:
+    Pool<A>& pool;
+    u64 id;
+    u64 deadline;
+    Handle<> job;
+
+    // Guarded by the pool's events_mut. Tracked timers stay registered until destroyed, so
+    // their handles can tell a timer that has not been awaited from one that has finished.
+    bool armed = false;
+    bool fired = false;
+    bool canceled = false;
+    bool tracked = false;
+
+    friend struct Pool<A>;
+};
+
+template<Allocator A = Alloc>
+struct Work_Deque {
+    // Chase-Lev deque: only the owning worker may push and pop (LIFO), any thread may steal
+    // (FIFO). Replaced buffers are kept alive until destruction, as a concurrent steal may
+    // still be reading from them.
+
+    Work_Deque() noexcept = default;
+    ~Work_Deque() noexcept {
+        Buffer* buffer = reinterpret_cast<Buffer*>(buffer_.load());
+        while(buffer) {
+            Buffer* prev = buffer->prev;
+            A::free(buffer);
+            buffer = prev;
+        }
+    }
+
+    Work_Deque(const Work_Deque&) noexcept = delete;
+    Work_Deque& operator=(const Work_Deque&) noexcept = delete;
+
+    Work_Deque(Work_Deque&&) noexcept = delete;
+    Work_Deque& operator=(Work_Deque&&) noexcept = delete;
+
+    void push(Handle<> job) noexcept {
+        i64 bottom = bottom_.load();
+        i64 top = top_.load();
+        Buffer* buffer = reinterpret_cast<Buffer*>(buffer_.load());
+        if(!buffer || bottom - top > static_cast<i64>(buffer->mask)) {
+            buffer = grow(buffer, top, bottom);
+        }
+        buffer->slots()[bottom & buffer->mask].exchange(
+            reinterpret_cast<i64>(job.handle.address()));
+        bottom_.exchange(bottom + 1);
+    }
+
+    [[nodiscard]] Opt<Handle<>> pop() noexcept {
+        i64 bottom = bottom_.load() - 1;
+        Buffer* buffer = reinterpret_cast<Buffer*>(buffer_.load());
+        bottom_.exchange(bottom);
+        i64 top = top_.load();
+
+        if(top > bottom) {
+            bottom_.exchange(bottom + 1);
+            return {};
+        }
+
+        Handle<> job = read(buffer, bottom);
+        if(top == bottom) {
+            // Last job: race with stealers for it
+            bool won = top_.compare_and_swap(top, top + 1) == top;
+            bottom_.exchange(bottom + 1);
+            if(!won) return {};
+        }
+        return Opt<Handle<>>{job};
+    }
+
+    [[nodiscard]] Opt<Handle<>> steal() noexcept {
+        i64 top = top_.load();
+        i64 bottom = bottom_.load();
+        if(top >= bottom) return {};
+
+        Buffer* buffer = reinterpret_cast<Buffer*>(buffer_.load());
+        Handle<> job = read(buffer, top);
+        if(top_.compare_and_swap(top, top + 1) != top) return {};
+        return Opt<Handle<>>{job};
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return bottom_.load() <= top_.load();
+    }
+
+private:
+    constexpr static u64 INITIAL_CAPACITY = 64;
+
+    struct Buffer {
+        u64 mask = 0;
+        Buffer* prev = null;
+
+        [[nodiscard]] Thread::Atomic* slots() noexcept {
+            return reinterpret_cast<Thread::Atomic*>(this + 1);
+        }
+    };
+
+    [[nodiscard]] static Handle<> read(Buffer* buffer, i64 idx) noexcept {
+        i64 address = buffer->slots()[idx & buffer->mask].load();
+        return Handle<>{std::coroutine_handle<>::from_address(reinterpret_cast<void*>(address))};
+    }
+
+    [[nodiscard]] Buffer* grow(Buffer* buffer, i64 top, i64 bottom) noexcept {
+        u64 capacity = buffer ? (buffer->mask + 1) * 2 : INITIAL_CAPACITY;
+
+        u64 size = sizeof(Buffer) + capacity * sizeof(Thread::Atomic);
+        Buffer* next = reinterpret_cast<Buffer*>(A::alloc(size, alignof(Buffer)));
+        new(next) Buffer{capacity - 1, buffer};
+        Libc::memset(next->slots(), 0, capacity * sizeof(Thread::Atomic));
+
+        for(i64 i = top; i < bottom; i++) {
+            next->slots()[i & next->mask].exchange(buffer->slots()[i & buffer->mask].load());
+        }
+        buffer_.exchange(reinterpret_cast<i64>(next));
+        return next;
+    }
+
+    Thread::Atomic top_, bottom_, buffer_;
+};
+
 template<Allocator A = Alloc>
 struct Pool {
+    // Jobs are queued in one lane per Thread::Priority, and workers serve the highest lane that
+    // has work. Lanes that keep being passed over age until they are served next.
+    constexpr static u64 PRIORITIES = static_cast<u64>(Thread::Priority::critical) + 1;
+    // A worker tries a lane first once it has served this many jobs from higher lanes.
+    constexpr static u64 AGING_LIMIT = 16;
+
+    struct Statistics {
+        // Jobs run from each lane, and how many of those were taken early by aging.
+        Array<u64, PRIORITIES> executed;
+        Array<u64, PRIORITIES> aged;
+    };
 
     explicit Pool() noexcept
         : thread_states{Vec<Thread_State, A>::make(Thread::hardware_threads() - 1)} {
@@ -65,7 +254,7 @@ struct Pool {
                 do_work(i);
             }));
         }
-        pending_events.push(Event{});
+        reactor.add(wake, WAKE_ID);
         event_thread = Thread::Thread([this] { do_events(); });
     }
     ~Pool() noexcept {
@@ -79,17 +268,24 @@ struct Pool {
 
         {
             Thread::Lock lock(events_mut);
-            pending_events[0].signal();
+            wake.signal();
         }
         event_thread.join();
 
         pending_events.clear();
+        free_events.clear();
 
         for(auto& state : thread_states) {
-            for(auto& job : state.jobs) {
-                // This still leaks pending continuations, as we can't control their destruction
-                // order wrt their waiting tasks.
-                job.handle.destroy();
+            // This still leaks pending continuations, as we can't control their destruction
+            // order wrt their waiting tasks.
+            for(u64 lane = 0; lane < PRIORITIES; lane++) {
+                for(auto& job : state.jobs[lane]) {
+                    job.handle.destroy();
+                }
+                Work_Deque<A>& deque = state.deques[lane];
+                for(Opt<Handle<>> job = deque.pop(); job.ok(); job = deque.pop()) {
+                    job->handle.destroy();
+                }
             }
         }
     }
@@ -100,114 +296,442 @@ struct Pool {
     Pool(Pool&&) noexcept = delete;
     Pool& operator=(Pool&&) noexcept = delete;
 
-    [[nodiscard]] Schedule<A> suspend() noexcept {
-        return Schedule<A>{*this};
+    [[nodiscard]] Schedule<A>
+    suspend(Thread::Priority priority = Thread::Priority::normal) noexcept {
+        return Schedule<A>{*this, priority};
     }
     [[nodiscard]] Schedule_Event<A> event(Event event) noexcept {
         return Schedule_Event<A>{rpp::move(event), *this};
     }
+    [[nodiscard]] Schedule_Timer<A> timer(u64 ms) noexcept {
+        return Schedule_Timer<A>{*this, ms};
+    }
 
     [[nodiscard]] u64 n_threads() const noexcept {
         return thread_states.length();
     }
 
+    // Counters are read one worker at a time, so concurrent jobs may be partially reflected.
+    [[nodiscard]] Statistics statistics() const noexcept {
+        Statistics stats;
+        for(const Thread_State& state : thread_states) {
+            for(u64 lane = 0; lane < PRIORITIES; lane++) {
+                stats.executed[lane] += Thread::load_relaxed(state.executed[lane]);
+                stats.aged[lane] += Thread::load_relaxed(state.aged[lane]);
+            }
+        }
+        return stats;
+    }
+
 private:
-    void enqueue(Handle<> job) noexcept {
+    void enqueue(Handle<> job, Thread::Priority priority = Thread::Priority::normal) noexcept {
+        u64 lane = static_cast<u64>(priority);
+        if(lane != NORMAL) queued[lane].incr();
+
+        // Jobs scheduled from one of our workers go on its own deque, where idle workers can
+        // steal them.
+        if(this_pool == this) {
+            thread_states[this_worker].deques[lane].push(rpp::move(job));
+            wake_one();
+            return;
+        }
+
+        // Prefer handing the job directly to a sleeping worker
+        if(sleepers.load() > 0) {
+            for(u64 i = 0; i < thread_states.length(); i++) {
+                if(thread_states[i].sleeping.load()) {
+                    submit(i, lane, rpp::move(job));
+                    return;
+                }
+            }
+        }
+
         for(u64 i = 0; i < thread_states.length(); i++) {
             Thread_State& state = thread_states[i];
             // Race on empty
-            if(state.jobs.empty()) {
-                Thread::Lock lock(state.mut);
-                state.jobs.push(rpp::move(job));
-                state.cond.signal();
+            if(state.jobs[lane].empty()) {
+                submit(i, lane, rpp::move(job));
                 return;
             }
         }
 
         // All queues more or less busy, choose next from low discrepancy sequence
         u64 i = static_cast<u64>(sequence.incr() * Math::PHI32) % thread_states.length();
-        Thread_State& state = thread_states[i];
+        submit(i, lane, rpp::move(job));
+    }
 
+    // Workers publish that they are parked while holding their mutex, so checking under the
+    // same lock means only a parked worker gets signaled. Awake workers find the job on their
+    // next pass, or while spinning.
+    void submit(u64 thread_idx, u64 lane, Handle<> job) noexcept {
+        Thread_State& state = thread_states[thread_idx];
         Thread::Lock lock(state.mut);
-        state.jobs.push(rpp::move(job));
-        state.cond.signal();
+        state.jobs[lane].push(rpp::move(job));
+        if(state.sleeping.load()) state.cond.signal();
+    }
+
+    void wake_one() noexcept {
+        if(sleepers.load() == 0) return;
+        for(auto& state : thread_states) {
+            if(state.sleeping.load()) {
+                Thread::Lock lock(state.mut);
+                state.cond.signal();
+                return;
+            }
+        }
     }
 
     void enqueue_event(Event event, Handle<> job) noexcept {
         Thread::Lock lock(events_mut);
         events_to_enqueue.emplace(rpp::move(event), rpp::move(job));
-        pending_events[0].signal();
+        wake.signal();
+    }
+
+    [[nodiscard]] u64 next_timer_id() noexcept {
+        return static_cast<u64>(timer_sequence.incr());
+    }
+
+    // Returns false if the timer was canceled before it was awaited.
+    [[nodiscard]] bool enqueue_timer(Schedule_Timer<A>& timer) noexcept {
+        Thread::Lock lock(events_mut);
+        if(timer.canceled) return false;
+
+        bool earliest = timers.empty() || timer.deadline < timers.top().deadline;
+        timers.push(Timer{timer.deadline, timer.id});
+        if(!timer.tracked) live_timers.insert(timer.id, &timer);
+        timer.armed = true;
+        if(earliest) wake.signal();
+        return true;
+    }
+
+    void track_timer(Schedule_Timer<A>& timer) noexcept {
+        Thread::Lock lock(events_mut);
+        if(timer.tracked) return;
+        if(!timer.armed) live_timers.insert(timer.id, &timer);
+        timer.tracked = true;
+    }
+
+    void forget_timer(Schedule_Timer<A>& timer) noexcept {
+        Thread::Lock lock(events_mut);
+        // Its heap entry is left behind like a canceled one.
+        if(timer.armed && !timer.fired && !timer.canceled) stale_timers++;
+        static_cast<void>(live_timers.try_erase(timer.id));
+    }
+
+    [[nodiscard]] bool cancel_timer(u64 id) noexcept {
+        Handle<> job;
+        {
+            Thread::Lock lock(events_mut);
+            Schedule_Timer<A>* timer = pending_timer(id);
+            if(!timer) return false;
+            timer->canceled = true;
+
+            // The waiting task will see the flag in enqueue_timer.
+            if(!timer->armed) return true;
+
+            job = timer->job;
+            stale_timers++;
+            if(stale_timers > timers.length() - stale_timers) compact_timers();
+        }
+        enqueue(job);
+        return true;
+    }
+
+    // Returns the timer if it has been neither fired nor canceled.
+    [[nodiscard]] Schedule_Timer<A>* pending_timer(u64 id) noexcept {
+        Opt<Ref<Schedule_Timer<A>*>> entry = live_timers.try_get(id);
+        if(!entry.ok()) return null;
+        Schedule_Timer<A>* timer = **entry;
+        if(timer->fired || timer->canceled) return null;
+        return timer;
+    }
+
+    // Rebuilds the heap without stale entries, so repeatedly canceling long timeouts does not
+    // grow it without bound.
+    void compact_timers() noexcept {
+        Heap<Timer, A> live{timers.length() - stale_timers};
+        for(const Timer& timer : timers) {
+            if(pending_timer(timer.id)) live.push(Timer{timer});
+        }
+        timers = rpp::move(live);
+        stale_timers = 0;
+    }
+
+    // Resumes expired timers and returns the milliseconds until the next one is due.
+    [[nodiscard]] u64 fire_timers() noexcept {
+        u64 now = Thread::perf_counter();
+        while(!timers.empty() && timers.top().deadline <= now) {
+            u64 id = timers.top().id;
+            timers.pop();
+
+            Schedule_Timer<A>* timer = pending_timer(id);
+            if(!timer) {
+                stale_timers--;
+                continue;
+            }
+            timer->fired = true;
+            Handle<> job = timer->job;
+            if(!timer->tracked) live_timers.erase(id);
+            enqueue(job);
+        }
+        if(timers.empty()) return Reactor::NO_TIMEOUT;
+
+        u64 ticks = timers.top().deadline - now;
+        u64 frequency = Thread::perf_frequency();
+        return (ticks * 1000 + frequency - 1) / frequency;
     }
 
     void do_work(u64 thread_idx) noexcept {
+        this_pool = this;
+        this_worker = thread_idx;
+
         Thread_State& state = thread_states[thread_idx];
+        RNG::Stream rng{hash(thread_idx)};
+
         for(;;) {
-            Handle<> job;
-            {
-                Thread::Lock lock(state.mut);
+            if(shutdown.load()) return;
 
-                while(state.jobs.empty() && !shutdown.load()) {
-                    state.cond.wait(state.mut);
-                }
-                if(shutdown.load()) return;
+            if(Opt<Handle<>> job = next_job(thread_idx, rng); job.ok()) {
+                job->handle.resume();
+                continue;
+            }
+            if(spin(thread_idx)) continue;
 
-                job = rpp::move(state.jobs.front());
-                state.jobs.pop();
+            // Publish that we are going to sleep before checking for work one last time, so
+            // that any producer either sees us sleeping or we see its job.
+            Thread::Lock lock(state.mut);
+            state.sleeping.exchange(1);
+            sleepers.incr();
+            while(!has_submitted(thread_idx) && !shutdown.load() && !can_steal(thread_idx)) {
+                state.cond.wait(state.mut);
             }
-            job.handle.resume();
+            sleepers.decr();
+            state.sleeping.exchange(0);
         }
     }
 
-    void do_events() noexcept {
-        for(;;) {
-            u64 idx = Event::wait_any(pending_events.slice());
-            Thread::Lock lock(events_mut);
-            if(idx == 0) {
-                if(shutdown.load()) return;
+    // Spins before parking, as fine-grained work tends to arrive soon after the last job. The
+    // budget doubles when spinning finds work and halves when the worker has to park, so idle
+    // pools stop burning cycles.
+    [[nodiscard]] bool spin(u64 thread_idx) noexcept {
+        Thread_State& state = thread_states[thread_idx];
+        for(u64 i = 1; i <= state.spin_limit; i++) {
+            Thread::pause();
+            if(i % SPIN_CHECK != 0) continue;
+            if(has_submitted(thread_idx) || can_steal(thread_idx) || shutdown.load()) {
+                state.spin_limit = Math::min(state.spin_limit * 2, SPIN_MAX);
+                return true;
+            }
+        }
+        state.spin_limit = Math::max(state.spin_limit / 2, SPIN_MIN);
+        return false;
+    }
 
-                for(auto& [event, state] : events_to_enqueue) {
-                    pending_events.push(rpp::move(event));
-                    pending_event_jobs.push(rpp::move(state));
-                }
-                events_to_enqueue.clear();
+    // Serves the highest lane with work, but first tries any lane that has been passed over
+    // AGING_LIMIT times, so lower priorities are delayed by a bounded number of jobs.
+    [[nodiscard]] Opt<Handle<>> next_job(u64 thread_idx, RNG::Stream& rng) noexcept {
+        Thread_State& state = thread_states[thread_idx];
+        for(u64 lane = 0; lane < PRIORITIES; lane++) {
+            if(state.skipped[lane] < AGING_LIMIT) continue;
+            state.skipped[lane] = 0;
+            if(Opt<Handle<>> job = take(thread_idx, lane, rng); job.ok()) {
+                Thread::store_relaxed(state.aged[lane], state.aged[lane] + 1);
+                return job;
+            }
+        }
+        for(u64 lane = PRIORITIES; lane-- > 0;) {
+            Opt<Handle<>> job = take(thread_idx, lane, rng);
+            if(!job.ok()) continue;
+            state.skipped[lane] = 0;
+            for(u64 lower = 0; lower < lane; lower++) state.skipped[lower]++;
+            return job;
+        }
+        return {};
+    }
+
+    [[nodiscard]] Opt<Handle<>> take(u64 thread_idx, u64 lane, RNG::Stream& rng) noexcept {
+        if(lane != NORMAL && queued[lane].load() == 0) return {};
+
+        Thread_State& state = thread_states[thread_idx];
+        Opt<Handle<>> job = state.deques[lane].pop();
+        if(!job.ok()) job = pop_submitted(thread_idx, lane);
+        if(!job.ok()) job = steal(thread_idx, lane, rng);
+        if(job.ok()) {
+            if(lane != NORMAL) queued[lane].decr();
+            Thread::store_relaxed(state.executed[lane], state.executed[lane] + 1);
+        }
+        return job;
+    }
 
-                pending_events[0].reset();
-            } else {
-                auto job = rpp::move(pending_event_jobs[idx - 1]);
+    [[nodiscard]] Opt<Handle<>> pop_submitted(u64 thread_idx, u64 lane) noexcept {
+        Thread_State& state = thread_states[thread_idx];
+        Thread::Lock lock(state.mut);
+        if(state.jobs[lane].empty()) return {};
+        Handle<> job = rpp::move(state.jobs[lane].front());
+        state.jobs[lane].pop();
+        return Opt<Handle<>>{job};
+    }
 
-                if(pending_events.length() > 2) {
-                    swap(pending_events[idx], pending_events.back());
-                    swap(pending_event_jobs[idx - 1], pending_event_jobs.back());
+    [[nodiscard]] Opt<Handle<>> steal(u64 thread_idx, u64 lane, RNG::Stream& rng) noexcept {
+        u64 n = thread_states.length();
+        u64 start = rng() % n;
+        for(u64 i = 0; i < n; i++) {
+            u64 victim_idx = (start + i) % n;
+            if(victim_idx == thread_idx) continue;
+
+            Thread_State& victim = thread_states[victim_idx];
+            Opt<Handle<>> job = victim.deques[lane].steal();
+            if(job.ok()) return job;
+
+            // Jobs submitted from outside the pool can be taken too, but don't wait for them
+            // if their owner is busy.
+            Queue<Handle<>, A>& jobs = victim.jobs[lane];
+            if(!jobs.empty() && victim.mut.try_lock()) {
+                if(!jobs.empty()) {
+                    Handle<> submitted = rpp::move(jobs.front());
+                    jobs.pop();
+                    victim.mut.unlock();
+                    return Opt<Handle<>>{submitted};
                 }
-                pending_events.pop();
-                pending_event_jobs.pop();
+                victim.mut.unlock();
+            }
+        }
+        return {};
+    }
 
-                enqueue(job);
+    [[nodiscard]] bool can_steal(u64 thread_idx) noexcept {
+        for(u64 i = 0; i < thread_states.length(); i++) {
+            if(i == thread_idx) continue;
+            Thread_State& victim = thread_states[i];
+            for(u64 lane = 0; lane < PRIORITIES; lane++) {
+                if(!victim.deques[lane].empty() || !victim.jobs[lane].empty()) return true;
             }
         }
+        return false;
     }
 
-    Thread::Atomic shutdown, sequence;
+    [[nodiscard]] bool has_submitted(u64 thread_idx) noexcept {
+        Thread_State& state = thread_states[thread_idx];
+        for(u64 lane = 0; lane < PRIORITIES; lane++) {
+            if(!state.jobs[lane].empty()) return true;
+        }
+        return false;
+    }
+
+    void do_events() noexcept {
+        Array<u64, EVENT_BATCH> ready;
+        for(;;) {
+            u64 timeout = 0;
+            {
+                Thread::Lock lock(events_mut);
+                timeout = fire_timers();
+            }
+            u64 n = reactor.wait(ready.slice(), timeout);
+            Thread::Lock lock(events_mut);
+            for(u64 i = 0; i < n; i++) {
+                if(ready[i] == WAKE_ID) {
+                    if(shutdown.load()) return;
+
+                    for(auto& [event, job] : events_to_enqueue) {
+                        u64 id = 0;
+                        if(free_events.empty()) {
+                            id = pending_events.length();
+                            pending_events.emplace(rpp::move(event), rpp::move(job));
+                        } else {
+                            id = free_events.back();
+                            free_events.pop();
+                            pending_events[id].emplace(rpp::move(event), rpp::move(job));
+                        }
+                        reactor.add(pending_events[id]->first, id);
+                    }
+                    events_to_enqueue.clear();
+
+                    wake.reset();
+                } else {
+                    u64 id = ready[i];
+                    Opt<Pair<Event, Handle<>>>& pending = pending_events[id];
+                    Handle<> job = pending->second;
+
+                    reactor.remove(pending->first);
+                    pending = Opt<Pair<Event, Handle<>>>{};
+                    free_events.push(id);
+
+                    enqueue(job);
+                }
+            }
+        }
+    }
 
-    struct Thread_State {
+    Thread::Atomic shutdown, sequence, sleepers, timer_sequence;
+
+    // Queued jobs are counted per lane so that workers can skip empty lanes without scanning
+    // every queue. The normal lane is always scanned, so pools that never use priorities don't
+    // pay for the counts.
+    constexpr static u64 NORMAL = static_cast<u64>(Thread::Priority::normal);
+    Thread::Atomic queued[PRIORITIES];
+
+    // Spin budgets are counted in pauses, checking for work every SPIN_CHECK of them.
+    constexpr static u64 SPIN_MIN = 32;
+    constexpr static u64 SPIN_MAX = 1024;
+    constexpr static u64 SPIN_CHECK = 16;
+
+    // Each worker's state gets its own cache lines.
+    struct alignas(64) Thread_State {
         Thread::Mutex mut;
         Thread::Cond cond;
-        Queue<Handle<>, A> jobs;
+        Queue<Handle<>, A> jobs[PRIORITIES];
+        Work_Deque<A> deques[PRIORITIES];
+        Thread::Atomic sleeping;
+        // Only touched by the owning worker: jobs served since each lane was last tried, and
+        // how long to spin before parking.
+        u64 skipped[PRIORITIES] = {};
+        u64 spin_limit = SPIN_MIN;
+        // Only written by the owning worker, and sampled with relaxed loads by statistics().
+        u64 executed[PRIORITIES] = {};
+        u64 aged[PRIORITIES] = {};
     };
     Vec<Thread_State, A> thread_states;
     Vec<Thread::Thread<A>, A> threads;
 
-    Vec<Event, A> pending_events;
-    Vec<Handle<>, A> pending_event_jobs;
+    // Pending events are registered with the reactor under their index, which stays stable
+    // until the event fires and the slot is recycled.
+    constexpr static u64 WAKE_ID = Limits<u64>::max();
+    constexpr static u64 EVENT_BATCH = 64;
+
+    Reactor reactor;
+    Event wake;
+    Vec<Opt<Pair<Event, Handle<>>>, A> pending_events;
+    Vec<u64, A> free_events;
     Vec<Pair<Event, Handle<>>, A> events_to_enqueue;
 
+    // Timers are ordered by deadline in a min-heap and resolved through live_timers. Canceling or
+    // destroying an armed timer leaves a stale heap entry in place until it expires or the heap
+    // is compacted.
+    struct Timer {
+        u64 deadline = 0;
+        u64 id = 0;
+        [[nodiscard]] bool operator<(const Timer& other) const noexcept {
+            return deadline < other.deadline;
+        }
+    };
+    Heap<Timer, A> timers;
+    Map<u64, Schedule_Timer<A>*, A> live_timers;
+    u64 stale_timers = 0;
+
     Thread::Thread<A> event_thread;
     Thread::Mutex events_mut;
 
+    static inline thread_local Pool* this_pool = null;
+    static inline thread_local u64 this_worker = 0;
+
     template<Allocator>
     friend struct Schedule;
     template<Allocator>
     friend struct Schedule_Event;
+    template<Allocator>
+    friend struct Schedule_Timer;
+    template<Allocator>
+    friend struct Timer_Handle;
 };
 
 } // namespace rpp::Async
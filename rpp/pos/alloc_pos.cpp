@@ -0,0 +1,37 @@
+
+#include "../base.h"
+
+#include <errno.h>
+#include <sys/mman.h>
+
+namespace rpp {
+
+[[nodiscard]] void* sys_reserve(u64 size) noexcept {
+    void* ret = mmap(null, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if(ret == MAP_FAILED) {
+        die("Failed to reserve % bytes: %", size, Log::sys_error());
+    }
+    return ret;
+}
+
+void sys_commit(void* mem, u64 size) noexcept {
+    if(mprotect(mem, size, PROT_READ | PROT_WRITE) == -1) {
+        die("Failed to commit % bytes: %", size, Log::sys_error());
+    }
+}
+
+void sys_discard(void* mem, u64 size) noexcept {
+    if(madvise(mem, size, MADV_FREE) == 0) return;
+    // MADV_FREE is not supported before Linux 4.5.
+    if(errno != EINVAL || madvise(mem, size, MADV_DONTNEED) == -1) {
+        warn("Failed to discard % bytes: %", size, Log::sys_error());
+    }
+}
+
+void sys_release(void* mem, u64 size) noexcept {
+    if(munmap(mem, size) == -1) {
+        die("Failed to release % bytes: %", size, Log::sys_error());
+    }
+}
+
+} // namespace rpp
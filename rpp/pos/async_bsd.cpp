@@ -1,6 +1,7 @@
 
 #include "../async.h"
 
+#include <errno.h>
 #include <sys/event.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -95,4 +96,62 @@ void Event::reset() const noexcept {
     RPP_UNREACHABLE;
 }
 
+Reactor::Reactor() noexcept {
+    fd = kqueue();
+    if(fd == -1) {
+        die("Failed to create kqueue: %", Log::sys_error());
+    }
+}
+
+Reactor::~Reactor() noexcept {
+    if(fd != -1) close(fd);
+    fd = -1;
+}
+
+void Reactor::add(const Event& event, u64 id) noexcept {
+    struct kevent change;
+    EV_SET(&change, event.fd, event.mask, EV_ADD | EV_ENABLE, 0, 0, reinterpret_cast<void*>(id));
+    if(kevent(fd, &change, 1, null, 0, null) == -1) {
+        die("Failed to add kevent: %", Log::sys_error());
+    }
+}
+
+void Reactor::remove(const Event& event) noexcept {
+    struct kevent change;
+    EV_SET(&change, event.fd, event.mask, EV_DELETE, 0, 0, null);
+    if(kevent(fd, &change, 1, null, 0, null) == -1) {
+        die("Failed to remove kevent: %", Log::sys_error());
+    }
+}
+
+[[nodiscard]] u64 Reactor::wait(Slice<u64> ready, u64 timeout_ms) noexcept {
+    assert(!ready.empty());
+
+    constexpr u64 BATCH = 64;
+    struct kevent signaled[BATCH];
+    int max = static_cast<int>(Math::min(ready.length(), BATCH));
+
+    timespec timeout = {};
+    timeout.tv_sec = static_cast<time_t>(timeout_ms / 1000);
+    timeout.tv_nsec = static_cast<long>((timeout_ms % 1000) * 1000000);
+    const timespec* wait_for = timeout_ms == NO_TIMEOUT ? null : &timeout;
+
+    int count = 0;
+    do {
+        count = kevent(fd, null, 0, signaled, max, wait_for);
+    } while((count == 0 && !wait_for) || (count == -1 && errno == EINTR));
+
+    if(count == -1) {
+        die("Failed to wait on kevents: %", Log::sys_error());
+    }
+
+    for(int i = 0; i < count; i++) {
+        if(signaled[i].flags & EV_ERROR) {
+            die("Failed to wait on kevents: %", Log::sys_error());
+        }
+        ready[i] = reinterpret_cast<u64>(signaled[i].udata);
+    }
+    return static_cast<u64>(count);
+}
+
 } // namespace rpp::Async
@@ -1,6 +1,7 @@
 
 #include "../async.h"
 
+#include <errno.h>
 #include <sys/epoll.h>
 #include <sys/eventfd.h>
 #include <unistd.h>
@@ -100,4 +101,61 @@ void Event::reset() const noexcept {
     RPP_UNREACHABLE;
 }
 
+Reactor::Reactor() noexcept {
+    fd = epoll_create1(EPOLL_CLOEXEC);
+    if(fd == -1) {
+        die("Failed to create epoll: %", Log::sys_error());
+    }
+}
+
+Reactor::~Reactor() noexcept {
+    if(fd != -1) {
+        int ret = close(fd);
+        assert(ret == 0);
+    }
+    fd = -1;
+}
+
+void Reactor::add(const Event& event, u64 id) noexcept {
+    epoll_event ev;
+    ev.events = event.mask;
+    ev.data.u64 = id;
+    int ret = epoll_ctl(fd, EPOLL_CTL_ADD, event.fd, &ev);
+    if(ret == -1) {
+        die("Failed to add event to epoll: %", Log::sys_error());
+    }
+}
+
+void Reactor::remove(const Event& event) noexcept {
+    int ret = epoll_ctl(fd, EPOLL_CTL_DEL, event.fd, null);
+    if(ret == -1) {
+        die("Failed to remove event from epoll: %", Log::sys_error());
+    }
+}
+
+[[nodiscard]] u64 Reactor::wait(Slice<u64> ready, u64 timeout_ms) noexcept {
+    assert(!ready.empty());
+
+    constexpr u64 BATCH = 64;
+    epoll_event evs[BATCH];
+    int max = static_cast<int>(Math::min(ready.length(), BATCH));
+    int timeout = timeout_ms == NO_TIMEOUT
+                      ? -1
+                      : static_cast<int>(Math::min(timeout_ms, static_cast<u64>(RPP_INT32_MAX)));
+
+    int ret = -1;
+    do {
+        ret = epoll_wait(fd, evs, max, timeout);
+    } while(ret == -1 && errno == EINTR);
+
+    if(ret == -1) {
+        die("Failed to wait on events: %", Log::sys_error());
+    }
+
+    for(int i = 0; i < ret; i++) {
+        ready[i] = evs[i].data.u64;
+    }
+    return static_cast<u64>(ret);
+}
+
 } // namespace rpp::Async
@@ -62,9 +62,4 @@ namespace rpp::Async {
     co_return true;
 }
 
-[[nodiscard]] Task<void> wait(Pool<>&, u64 ms) noexcept {
-    Thread::sleep(ms);
-    co_return;
-}
-
 } // namespace rpp::Async
@@ -2,84 +2,526 @@
 #include "../asyncio.h"
 #include "../files.h"
 
+#include <errno.h>
 #include <fcntl.h>
+#include <string.h>
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
-#include <sys/timerfd.h>
+#include <sys/syscall.h>
 #include <unistd.h>
 
-// The file IO operations are not actually async.
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define RPP_IO_URING
+#endif
+
+// File operations are submitted to io_uring when the kernel supports it, and otherwise run on a
+// small set of blocking IO threads. Either way, completion signals an eventfd that the calling
+// task waits on through the pool, so pool workers never block on the disk.
 
 namespace rpp::Async {
 
-[[nodiscard]] Task<Opt<Vec<u8, Files::Alloc>>> read(Pool<>& pool, String_View path_) noexcept {
+[[nodiscard]] static String_View error(i64 code) noexcept {
+    constexpr int buffer_size = 256;
+    static thread_local char buffer[buffer_size];
+    return String_View{strerror_r(static_cast<int>(code), buffer, buffer_size)};
+}
+
+namespace {
+
+struct Operation {
+    enum class Kind : u8 { open, size, read, write, close };
+
+    Kind kind = Kind::open;
+    i32 fd = -1;
+    i32 flags = 0;
+    const char* path = null;
+    u8* data = null;
+    u64 length = 0;
+    u64 offset = 0;
 
-    int fd = -1;
-    Region(R) {
-        auto path = path_.terminate<Mregion<R>>();
-        fd = open(reinterpret_cast<const char*>(path.data()), O_RDONLY);
+    // Set by the backend before signaling event: a non-negative result or -errno.
+    i64 result = 0;
+    i32 event = -1;
+
+#ifdef RPP_IO_URING
+    struct statx stat = {};
+#endif
+};
+
+static void complete(Operation& op, i64 result) noexcept {
+    op.result = result;
+    u64 value = 1;
+    if(::write(op.event, &value, sizeof(value)) == -1) {
+        die("Failed to signal IO completion: %", Log::sys_error());
     }
+}
 
-    if(fd == -1) {
-        warn("Failed to open file %: %", path_, Log::sys_error());
-        co_return {};
+[[nodiscard]] static i64 perform_blocking(Operation& op) noexcept {
+    i64 ret = -1;
+    switch(op.kind) {
+    case Operation::Kind::open: {
+        ret = open(op.path, op.flags, 0644);
+    } break;
+    case Operation::Kind::size: {
+        struct stat st;
+        ret = fstat(op.fd, &st);
+        if(ret == 0) ret = static_cast<i64>(st.st_size);
+    } break;
+    case Operation::Kind::read: {
+        ret = pread(op.fd, op.data, op.length, static_cast<off_t>(op.offset));
+    } break;
+    case Operation::Kind::write: {
+        ret = pwrite(op.fd, op.data, op.length, static_cast<off_t>(op.offset));
+    } break;
+    case Operation::Kind::close: {
+        ret = close(op.fd);
+    } break;
     }
+    return ret == -1 ? -static_cast<i64>(errno) : ret;
+}
 
-    off_t full_size = lseek(fd, 0, SEEK_END);
-    lseek(fd, 0, SEEK_SET);
+struct Offload {
 
-    assert(full_size <= UINT32_MAX);
+    void start() noexcept {
+        for(u64 i = 0; i < N_THREADS; i++) {
+            threads.push(Thread::Thread([this] { do_work(); }));
+        }
+    }
 
-    Vec<u8, Files::Alloc> data(static_cast<u64>(full_size));
-    data.resize(static_cast<u64>(full_size));
+    void shutdown() noexcept {
+        {
+            Thread::Lock lock(mutex);
+            stop = true;
+            cond.broadcast();
+        }
+        threads.clear();
+        ops = Queue<Operation*, Alloc>{};
+    }
 
-    if(::read(fd, data.data(), full_size) == -1) {
-        warn("Failed to read file %: %", path_, Log::sys_error());
-        co_return {};
+    void submit(Operation& op) noexcept {
+        Thread::Lock lock(mutex);
+        ops.push(&op);
+        cond.signal();
     }
 
-    close(fd);
-    co_return Opt{rpp::move(data)};
+private:
+    void do_work() noexcept {
+        for(;;) {
+            Operation* op = null;
+            {
+                Thread::Lock lock(mutex);
+                while(ops.empty() && !stop) {
+                    cond.wait(mutex);
+                }
+                if(stop) return;
+                op = ops.front();
+                ops.pop();
+            }
+            complete(*op, perform_blocking(*op));
+        }
+    }
+
+    constexpr static u64 N_THREADS = 4;
+
+    Thread::Mutex mutex;
+    Thread::Cond cond;
+    Queue<Operation*, Alloc> ops;
+    Vec<Thread::Thread<Alloc>, Alloc> threads;
+    bool stop = false;
+};
+
+#ifdef RPP_IO_URING
+
+struct Ring {
+
+    [[nodiscard]] bool start() noexcept {
+        io_uring_params params = {};
+        fd = static_cast<i32>(syscall(__NR_io_uring_setup, ENTRIES, &params));
+        if(fd < 0) {
+            fd = -1;
+            return false;
+        }
+        if(!(params.features & IORING_FEAT_NODROP) || !supported()) {
+            close(fd);
+            fd = -1;
+            return false;
+        }
+
+        sq_size = params.sq_off.array + params.sq_entries * sizeof(u32);
+        cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if(single_mmap) {
+            sq_size = cq_size = Math::max(sq_size, cq_size);
+        }
+
+        sq_ring = mmap(null, sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                       IORING_OFF_SQ_RING);
+        if(sq_ring == MAP_FAILED) {
+            die("Failed to map io_uring submission queue: %", Log::sys_error());
+        }
+        cq_ring = sq_ring;
+        if(!single_mmap) {
+            cq_ring = mmap(null, cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                           IORING_OFF_CQ_RING);
+            if(cq_ring == MAP_FAILED) {
+                die("Failed to map io_uring completion queue: %", Log::sys_error());
+            }
+        }
+        sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = reinterpret_cast<io_uring_sqe*>(mmap(null, sqes_size, PROT_READ | PROT_WRITE,
+                                                    MAP_SHARED | MAP_POPULATE, fd,
+                                                    IORING_OFF_SQES));
+        if(sqes == MAP_FAILED) {
+            die("Failed to map io_uring submission entries: %", Log::sys_error());
+        }
+
+        u8* sq = reinterpret_cast<u8*>(sq_ring);
+        sq_head = reinterpret_cast<u32*>(sq + params.sq_off.head);
+        sq_tail = reinterpret_cast<u32*>(sq + params.sq_off.tail);
+        sq_mask = *reinterpret_cast<u32*>(sq + params.sq_off.ring_mask);
+        sq_entries = params.sq_entries;
+        sq_array = reinterpret_cast<u32*>(sq + params.sq_off.array);
+
+        u8* cq = reinterpret_cast<u8*>(cq_ring);
+        cq_head = reinterpret_cast<u32*>(cq + params.cq_off.head);
+        cq_tail = reinterpret_cast<u32*>(cq + params.cq_off.tail);
+        cq_mask = *reinterpret_cast<u32*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        reaper = Thread::Thread([this] { do_reap(); });
+        return true;
+    }
+
+    void shutdown() noexcept {
+        if(fd == -1) return;
+
+        // A null operation tells the reaper to exit.
+        {
+            Thread::Lock lock(mutex);
+            static_cast<void>(push(IORING_OP_NOP, null));
+            enter();
+        }
+        reaper.join();
+
+        munmap(sqes, sqes_size);
+        if(!single_mmap) munmap(cq_ring, cq_size);
+        munmap(sq_ring, sq_size);
+        close(fd);
+        fd = -1;
+    }
+
+    void submit(Operation& op) noexcept {
+        Thread::Lock lock(mutex);
+        switch(op.kind) {
+        case Operation::Kind::open: {
+            io_uring_sqe& sqe = push(IORING_OP_OPENAT, &op);
+            sqe.fd = AT_FDCWD;
+            sqe.addr = reinterpret_cast<u64>(op.path);
+            sqe.len = 0644;
+            sqe.open_flags = static_cast<u32>(op.flags);
+        } break;
+        case Operation::Kind::size: {
+            // An empty path with AT_EMPTY_PATH stats the open file itself.
+            io_uring_sqe& sqe = push(IORING_OP_STATX, &op);
+            sqe.fd = op.fd;
+            sqe.addr = reinterpret_cast<u64>("");
+            sqe.statx_flags = AT_EMPTY_PATH;
+            sqe.len = STATX_SIZE;
+            sqe.off = reinterpret_cast<u64>(&op.stat);
+        } break;
+        case Operation::Kind::read: {
+            io_uring_sqe& sqe = push(IORING_OP_READ, &op);
+            sqe.fd = op.fd;
+            sqe.addr = reinterpret_cast<u64>(op.data);
+            sqe.len = static_cast<u32>(Math::min(op.length, u64{UINT32_MAX}));
+            sqe.off = op.offset;
+        } break;
+        case Operation::Kind::write: {
+            io_uring_sqe& sqe = push(IORING_OP_WRITE, &op);
+            sqe.fd = op.fd;
+            sqe.addr = reinterpret_cast<u64>(op.data);
+            sqe.len = static_cast<u32>(Math::min(op.length, u64{UINT32_MAX}));
+            sqe.off = op.offset;
+        } break;
+        case Operation::Kind::close: {
+            io_uring_sqe& sqe = push(IORING_OP_CLOSE, &op);
+            sqe.fd = op.fd;
+        } break;
+        }
+        enter();
+    }
+
+private:
+    [[nodiscard]] bool supported() noexcept {
+        constexpr u64 n_ops = 256;
+        u64 size = sizeof(io_uring_probe) + n_ops * sizeof(io_uring_probe_op);
+
+        Region(R) {
+            auto* probe = reinterpret_cast<io_uring_probe*>(Mregion<R>::alloc(size));
+            Libc::memset(probe, 0, size);
+            if(syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, n_ops) < 0) {
+                return false;
+            }
+            for(u8 op : {IORING_OP_NOP, IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ,
+                         IORING_OP_WRITE, IORING_OP_CLOSE}) {
+                if(op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    [[nodiscard]] io_uring_sqe& push(u8 opcode, Operation* op) noexcept {
+        // Every push is followed by enter() under the same lock, so the kernel has always consumed
+        // the previous entries and the submission queue can't be full here. The kernel only reads
+        // the entry during enter(), so it may still be filled in after the tail is published.
+        u32 tail = *sq_tail;
+        assert(tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE) < sq_entries);
+
+        u32 idx = tail & sq_mask;
+        io_uring_sqe& sqe = sqes[idx];
+        Libc::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = opcode;
+        sqe.user_data = reinterpret_cast<u64>(op);
+        sq_array[idx] = idx;
+
+        __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+        return sqe;
+    }
+
+    void enter() noexcept {
+        for(;;) {
+            i64 ret = syscall(__NR_io_uring_enter, fd, 1, 0, 0, null, 0);
+            if(ret == 1) return;
+            if(ret == -1 && (errno == EINTR || errno == EAGAIN || errno == EBUSY)) {
+                // The completion queue is backed up; let the reaper drain it.
+                Thread::pause();
+                continue;
+            }
+            die("Failed to submit to io_uring: %", Log::sys_error());
+        }
+    }
+
+    void do_reap() noexcept {
+        for(;;) {
+            i64 ret = syscall(__NR_io_uring_enter, fd, 0, 1, IORING_ENTER_GETEVENTS, null, 0);
+            if(ret == -1 && errno != EINTR) {
+                die("Failed to wait on io_uring: %", Log::sys_error());
+            }
+
+            bool stop = false;
+            u32 head = *cq_head;
+            u32 tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+            for(; head != tail; head++) {
+                io_uring_cqe& cqe = cqes[head & cq_mask];
+                Operation* op = reinterpret_cast<Operation*>(cqe.user_data);
+                if(!op) {
+                    stop = true;
+                    continue;
+                }
+                i64 result = cqe.res;
+                if(op->kind == Operation::Kind::size && result == 0) {
+                    result = static_cast<i64>(op->stat.stx_size);
+                }
+                complete(*op, result);
+            }
+            __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+
+            if(stop) return;
+        }
+    }
+
+    constexpr static u32 ENTRIES = 256;
+
+    i32 fd = -1;
+    bool single_mmap = false;
+
+    void* sq_ring = null;
+    void* cq_ring = null;
+    io_uring_sqe* sqes = null;
+    u64 sq_size = 0, cq_size = 0, sqes_size = 0;
+
+    u32* sq_head = null;
+    u32* sq_tail = null;
+    u32* sq_array = null;
+    u32 sq_mask = 0, sq_entries = 0;
+
+    u32* cq_head = null;
+    u32* cq_tail = null;
+    io_uring_cqe* cqes = null;
+    u32 cq_mask = 0;
+
+    Thread::Mutex mutex;
+    Thread::Thread<Alloc> reaper;
+};
+
+#endif
+
+struct Backend {
+
+    Backend() noexcept {
+#ifdef RPP_IO_URING
+        use_ring = ring.start();
+#endif
+        if(!use_ring) offload.start();
+        Profile::finalizer([this]() { shutdown(); });
+    }
+    ~Backend() noexcept {
+        shutdown();
+    }
+
+    void submit(Operation& op) noexcept {
+        assert(running);
+#ifdef RPP_IO_URING
+        if(use_ring) {
+            ring.submit(op);
+            return;
+        }
+#endif
+        offload.submit(op);
+    }
+
+    void shutdown() noexcept {
+        if(!running) return;
+        running = false;
+#ifdef RPP_IO_URING
+        if(use_ring) {
+            ring.shutdown();
+            return;
+        }
+#endif
+        offload.shutdown();
+    }
+
+private:
+    bool running = true;
+    bool use_ring = false;
+#ifdef RPP_IO_URING
+    Ring ring;
+#endif
+    Offload offload;
+};
+
+[[nodiscard]] Backend& backend() noexcept {
+    static Backend instance;
+    return instance;
 }
 
-[[nodiscard]] Task<bool> write(Pool<>& pool, String_View path_, Slice<u8> data) noexcept {
+} // namespace
 
-    int fd = -1;
-    Region(R) {
-        auto path = path_.terminate<Mregion<R>>();
-        fd = open(reinterpret_cast<const char*>(path.data()), O_WRONLY | O_CREAT | O_TRUNC);
+[[nodiscard]] static Task<i64> perform(Pool<>& pool, Operation& op) noexcept {
+    i32 event = eventfd(0, EFD_CLOEXEC);
+    if(event == -1) {
+        die("Failed to create event: %", Log::sys_error());
     }
+    op.event = event;
+    backend().submit(op);
+    co_await pool.event(Event::of_sys(event, EPOLLIN));
+    co_return op.result;
+}
 
-    if(fd == -1) {
-        warn("Failed to create file %: %", path_, Log::sys_error());
-        co_return false;
+[[nodiscard]] Task<Opt<Vec<u8, Files::Alloc>>> read(Pool<>& pool, String_View path_) noexcept {
+
+    auto path = path_.terminate<Files::Alloc>();
+
+    Operation open_op;
+    open_op.kind = Operation::Kind::open;
+    open_op.path = reinterpret_cast<const char*>(path.data());
+    open_op.flags = O_RDONLY | O_CLOEXEC;
+    i64 fd = co_await perform(pool, open_op);
+
+    if(fd < 0) {
+        warn("Failed to open file %: %", path_, error(-fd));
+        co_return {};
     }
 
-    if(::write(fd, data.data(), data.length()) == -1) {
-        warn("Failed to write file %: %", path_, Log::sys_error());
-        co_return false;
+    Operation close_op;
+    close_op.kind = Operation::Kind::close;
+    close_op.fd = static_cast<i32>(fd);
+
+    // Size the file we opened, as the path may have been replaced since.
+    Operation size_op;
+    size_op.kind = Operation::Kind::size;
+    size_op.fd = static_cast<i32>(fd);
+    i64 full_size = co_await perform(pool, size_op);
+
+    if(full_size < 0) {
+        warn("Failed to size file %: %", path_, error(-full_size));
+        static_cast<void>(co_await perform(pool, close_op));
+        co_return {};
+    }
+
+    Vec<u8, Files::Alloc> data(static_cast<u64>(full_size));
+    data.resize(static_cast<u64>(full_size));
+
+    bool ok = true;
+    for(u64 done = 0; done < data.length();) {
+        Operation read_op;
+        read_op.kind = Operation::Kind::read;
+        read_op.fd = static_cast<i32>(fd);
+        read_op.data = data.data() + done;
+        read_op.length = data.length() - done;
+        read_op.offset = done;
+        i64 ret = co_await perform(pool, read_op);
+
+        if(ret <= 0) {
+            if(ret < 0) warn("Failed to read file %: %", path_, error(-ret));
+            else warn("Failed to read file %: unexpected end of file", path_);
+            ok = false;
+            break;
+        }
+        done += static_cast<u64>(ret);
     }
 
-    close(fd);
-    co_return true;
+    static_cast<void>(co_await perform(pool, close_op));
+
+    if(!ok) co_return {};
+    co_return Opt{rpp::move(data)};
 }
 
-[[nodiscard]] Task<void> wait(Pool<>& pool, u64 ms) noexcept {
+[[nodiscard]] Task<bool> write(Pool<>& pool, String_View path_, Slice<u8> data) noexcept {
+
+    auto path = path_.terminate<Files::Alloc>();
+
+    Operation open_op;
+    open_op.kind = Operation::Kind::open;
+    open_op.path = reinterpret_cast<const char*>(path.data());
+    open_op.flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+    i64 fd = co_await perform(pool, open_op);
 
-    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
-    if(fd == -1) {
-        die("Failed to create timerfd: %", Log::sys_error());
+    if(fd < 0) {
+        warn("Failed to create file %: %", path_, error(-fd));
+        co_return false;
     }
 
-    itimerspec spec = {};
-    spec.it_value.tv_sec = ms / 1000;
-    spec.it_value.tv_nsec = (ms % 1000) * 1000000;
+    bool ok = true;
+    for(u64 done = 0; done < data.length();) {
+        Operation write_op;
+        write_op.kind = Operation::Kind::write;
+        write_op.fd = static_cast<i32>(fd);
+        write_op.data = const_cast<u8*>(data.data()) + done;
+        write_op.length = data.length() - done;
+        write_op.offset = done;
+        i64 ret = co_await perform(pool, write_op);
 
-    if(timerfd_settime(fd, 0, &spec, null) == -1) {
-        die("Failed to set timerfd: %", Log::sys_error());
+        if(ret <= 0) {
+            warn("Failed to write file %: %", path_, error(ret < 0 ? -ret : EIO));
+            ok = false;
+            break;
+        }
+        done += static_cast<u64>(ret);
     }
 
-    co_await pool.event(Async::Event::of_sys(fd, EPOLLIN));
+    Operation close_op;
+    close_op.kind = Operation::Kind::close;
+    close_op.fd = static_cast<i32>(fd);
+    static_cast<void>(co_await perform(pool, close_op));
+
+    co_return ok;
 }
 
 } // namespace rpp::Async
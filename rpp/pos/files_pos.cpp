@@ -59,6 +59,17 @@ namespace rpp::Files {
     return true;
 }
 
+[[nodiscard]] bool remove(String_View path_) noexcept {
+    Region(R) {
+        auto path = path_.terminate<Mregion<R>>();
+        if(unlink(reinterpret_cast<const char*>(path.data()))) {
+            warn("Failed to remove file %: %", path_, Log::sys_error());
+            return false;
+        }
+        return true;
+    }
+}
+
 [[nodiscard]] Opt<File_Time> last_write_time(String_View path_) noexcept {
     Region(R) {
         auto path = path_.terminate<Mregion<R>>();
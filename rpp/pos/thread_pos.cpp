@@ -54,6 +54,22 @@ void pause() noexcept {
 #endif
 }
 
+[[nodiscard]] u64 load_relaxed(const u64& value) noexcept {
+    return __atomic_load_n(&value, __ATOMIC_RELAXED);
+}
+
+void store_relaxed(u64& value, u64 set_to) noexcept {
+    __atomic_store_n(&value, set_to, __ATOMIC_RELAXED);
+}
+
+[[nodiscard]] u64 load_acquire(const u64& value) noexcept {
+    return __atomic_load_n(&value, __ATOMIC_ACQUIRE);
+}
+
+void store_release(u64& value, u64 set_to) noexcept {
+    __atomic_store_n(&value, set_to, __ATOMIC_RELEASE);
+}
+
 [[nodiscard]] u64 perf_counter() noexcept {
     u64 ticks;
     struct timespec now;
@@ -231,6 +247,48 @@ void Mutex::unlock() noexcept {
     return true;
 }
 
+Shared_Mutex::Shared_Mutex() noexcept {
+    int ret = pthread_rwlock_init(&lock_, null);
+    if(ret) {
+        die("Failed to create rwlock: %", error(ret));
+    }
+}
+
+Shared_Mutex::~Shared_Mutex() noexcept {
+    int ret = pthread_rwlock_destroy(&lock_);
+    if(ret) {
+        die("Failed to destroy rwlock: %", error(ret));
+    }
+}
+
+void Shared_Mutex::lock() noexcept {
+    int ret = pthread_rwlock_wrlock(&lock_);
+    if(ret) {
+        die("Failed to lock rwlock: %", error(ret));
+    }
+}
+
+void Shared_Mutex::unlock() noexcept {
+    int ret = pthread_rwlock_unlock(&lock_);
+    if(ret) {
+        die("Failed to unlock rwlock: %", error(ret));
+    }
+}
+
+void Shared_Mutex::lock_shared() noexcept {
+    int ret = pthread_rwlock_rdlock(&lock_);
+    if(ret) {
+        die("Failed to shared lock rwlock: %", error(ret));
+    }
+}
+
+void Shared_Mutex::unlock_shared() noexcept {
+    int ret = pthread_rwlock_unlock(&lock_);
+    if(ret) {
+        die("Failed to shared unlock rwlock: %", error(ret));
+    }
+}
+
 [[nodiscard]] i64 Atomic::load() const noexcept {
     return __atomic_load_n(&value_, __ATOMIC_SEQ_CST);
 }
@@ -243,6 +301,10 @@ i64 Atomic::decr() noexcept {
     return __atomic_fetch_sub(&value_, 1, __ATOMIC_SEQ_CST) - 1;
 }
 
+i64 Atomic::add(i64 value) noexcept {
+    return __atomic_add_fetch(&value_, value, __ATOMIC_SEQ_CST);
+}
+
 i64 Atomic::exchange(i64 value) noexcept {
     return __atomic_exchange_n(&value_, value, __ATOMIC_SEQ_CST);
 }
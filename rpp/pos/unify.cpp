@@ -1,6 +1,7 @@
 
 #include "../base.h"
 
+#include "alloc_pos.cpp"
 #ifdef RPP_OS_MACOS
 #include "async_bsd.cpp"
 #include "asyncio_bsd.cpp"
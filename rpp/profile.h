@@ -22,6 +22,24 @@ constexpr bool DO_PROFILE = true;
 
 #define Trace(NAME) RPP_TRACE1(NAME, __COUNTER__)
 
+namespace detail {
+
+// Identifies a location made by RPP_HERE by the addresses of its strings, which are literals.
+// Scope names only use the function fields.
+struct Location_Key {
+    u64 function = 0, function_length = 0;
+    u64 file = 0, file_length = 0;
+    u64 line = 0;
+
+    [[nodiscard]] bool operator==(const Location_Key& other) const noexcept = default;
+};
+
+} // namespace detail
+
+RPP_NAMED_RECORD(detail::Location_Key, "Location_Key", RPP_FIELD(function),
+                 RPP_FIELD(function_length), RPP_FIELD(file), RPP_FIELD(file_length),
+                 RPP_FIELD(line));
+
 struct Profile {
 
     static float begin_frame() noexcept;
@@ -33,13 +51,25 @@ struct Profile {
     static void enter(String_View l) noexcept;
     static void exit() noexcept;
 
+    constexpr static u32 UNKNOWN_ALLOCATOR = RPP_UINT32_MAX;
+    constexpr static u64 MAX_ALLOCATORS = 256;
+
     struct Alloc {
         String_View name;
         void* address = null;
         u64 size = 0; // 0 means free
+        u32 allocator = UNKNOWN_ALLOCATOR;
     };
     static void alloc(Alloc a) noexcept;
 
+    // Dense id for the allocator named N, assigned on first use.
+    template<Literal N>
+    [[nodiscard]] static u32 allocator_id() noexcept {
+        static u32 id = register_allocator(String_View{N});
+        return id;
+    }
+    [[nodiscard]] static u32 register_allocator(String_View name) noexcept;
+
     [[nodiscard]] static Time_Point timestamp() noexcept;
     [[nodiscard]] static f32 ms(Time_Point duration) noexcept;
     [[nodiscard]] static f32 s(Time_Point duration) noexcept;
@@ -62,22 +92,35 @@ struct Profile {
 
     struct Timing_Node {
         Log::Location loc;
+        u32 location = 0;
         Time_Point begin = 0, end = 0;
         Time_Point self_time = 0, heir_time = 0;
         u64 calls = 0;
         u64 parent = 0;
-        Vec<u64, Mhidden> children;
+        Small_Vec<u64, 4, Mhidden> children;
 
-        [[nodiscard]] static Timing_Node make(Log::Location loc, u64 parent) noexcept {
+        [[nodiscard]] static Timing_Node make(Log::Location loc, u32 location, u64 parent,
+                                              Time_Point begin) noexcept {
             Timing_Node ret;
             ret.loc = rpp::move(loc);
+            ret.location = location;
             ret.parent = parent;
-            ret.begin = timestamp();
+            ret.begin = begin;
             ret.calls = 1;
             return ret;
         }
     };
 
+    // Scopes are recorded as events in a per-thread buffer without locking. The buffer is
+    // folded into the current frame's timing tree when it fills up and when the frame ends.
+    constexpr static u64 EVENT_CAPACITY = 4096;
+
+    struct Event {
+        Time_Point time = 0;
+        u32 location = 0;
+        bool enter = false;
+    };
+
     template<typename F>
     static void iterate_timings(F&& f) noexcept {
         Thread::Lock lock(threads_lock);
@@ -103,6 +146,13 @@ struct Profile {
         }
     }
 
+    // Streams scopes, frame boundaries, and allocator sizes to path as Chrome trace events,
+    // which chrome://tracing and Perfetto can open. Each thread appends its buffered events to
+    // the file when the buffer fills, when its frame ends, and when it exits. Stopping the trace
+    // writes out whatever every registered thread has buffered so far.
+    [[nodiscard]] static bool start_trace(String_View path) noexcept;
+    static void stop_trace() noexcept;
+
     static void finalizer(Function<void()> f) noexcept;
     static void finalize() noexcept;
 
@@ -110,22 +160,51 @@ private:
     static void register_thread() noexcept;
     static void unregister_thread() noexcept;
 
-    struct Alloc_Profile {
-        Alloc_Profile() noexcept {
-        }
-
+    struct Alloc_Counters {
         i64 allocates = 0, frees = 0;
         i64 allocate_size = 0, free_size = 0;
-        i64 high_water = 0;
-        i64 current_set_size = 0;
-        Map<void*, u64, Mhidden> current_set;
     };
 
+    // Current size stays global so trace counters and the high water mark are exact when
+    // memory is freed on a different thread than it was allocated on. Each allocator gets its
+    // own cache lines so neighbours don't contend.
+    struct alignas(64) Alloc_Profile {
+        Thread::Atomic current_size, high_water;
+        String_View name;
+        Alloc_Counters totals;
+    };
+
+    // Each thread counts its own allocations without synchronization. Shards are merged into
+    // the totals when their thread exits and at finalize.
+    struct Alloc_Shard {
+        ~Alloc_Shard() noexcept {
+            merge(*this);
+            alloc_shard_destroyed = true;
+        }
+        Vec<Alloc_Counters, Mhidden> counters;
+    };
+
+    struct Live_Alloc {
+        u64 size = 0;
+        u32 allocator = 0;
+    };
+
+    // Live addresses are spread over independently locked shards.
+    constexpr static u64 ADDRESS_SHARDS = 64;
+
+    struct alignas(64) Address_Shard {
+        Thread::Mutex lock;
+        Map<void*, Live_Alloc, Mhidden> live;
+    };
+
+    [[nodiscard]] static i64 count(u32 allocator, i64 size) noexcept;
+    static void merge(Alloc_Shard& shard) noexcept;
+
     struct Frame_Profile {
         [[nodiscard]] Time_Point begin() noexcept;
         void end() noexcept;
-        void enter(Log::Location loc) noexcept;
-        void exit() noexcept;
+        void enter(u32 location, const Log::Location& loc, Time_Point time) noexcept;
+        void exit(Time_Point time) noexcept;
         void compute_self_times(u64 idx) noexcept;
 
         u64 current_node = 0;
@@ -142,32 +221,83 @@ private:
         }
 
         void finalize() noexcept {
+            if(!during_frame) {
+                Thread::Lock lock(frames_lock);
+                replay();
+            }
             frames = {};
             if(during_frame) Profile::end_frame();
             if(registered) Profile::unregister_thread();
+            events = {};
+            locations = {};
+            location_keys = {};
+            name_keys = {};
+            location_ids = {};
+            names = {};
+            // No other thread can reach this one once it has unregistered.
+            flush_trace();
+            trace = {};
         }
 
+        [[nodiscard]] u32 intern(const Log::Location& loc) noexcept;
+        [[nodiscard]] u32 intern(String_View name) noexcept;
+        void record(Event event) noexcept;
+        void replay() noexcept;
+        void trace_events(u64 count) noexcept;
+
+        [[nodiscard]] bool trace_ready() noexcept;
+        void trace_frame(Time_Point time, bool enter) noexcept;
+        void trace_alloc(String_View name, i64 size) noexcept;
+        void flush_trace() noexcept;
+
         bool ready() noexcept {
             if(!registered) Profile::register_thread();
-            return during_frame;
+            return during_frame || tracing.load() != 0;
         }
 
         bool registered = false;
         bool during_frame = false;
+        Thread::Id id = 0;
         Thread::Mutex frames_lock;
         Queue<Frame_Profile, Mhidden> frames;
+
+        // Guards clearing events, growing locations, and the trace buffer against stop_trace.
+        // Pushing an event only publishes the new length, which stop_trace reads up to.
+        Thread::Mutex trace_lock;
+        Vec<Event, Mhidden> events;
+        u64 published = 0;
+        u64 traced = 0; // Events before this index have been written to the trace buffer.
+        Vec<Log::Location, Mhidden> locations;
+        Map<detail::Location_Key, u32, Mhidden> location_keys;
+        Map<detail::Location_Key, u32, Mhidden> name_keys;
+        Map<Log::Location, u32, Mhidden> location_ids;
+        // Copies of scope names, which may not outlive the scope that entered them.
+        Vec<String<Mhidden>, Mhidden> names;
+
+        u64 trace_generation = 0;
+        Vec<u8, Mhidden> trace;
     };
 
+    constexpr static u64 TRACE_FLUSH = Math::KB(64);
+
     static inline Thread::Mutex threads_lock;
-    static inline Thread::Mutex allocs_lock;
+    static inline Thread::Mutex allocators_lock;
     static inline Thread::Mutex finalizers_lock;
+    static inline Thread::Atomic tracing; // Generation of the active trace, or zero.
     static inline thread_local Thread_Profile this_thread;
     static inline thread_local bool this_thread_destroyed = false;
+    static inline thread_local Alloc_Shard alloc_shard;
+    static inline thread_local bool alloc_shard_destroyed = false;
     static inline Map<Thread::Id, Ref<Thread_Profile>, Mhidden> threads;
-    static inline Map<String_View, Alloc_Profile, Mhidden> allocs;
+    static inline Map<String_View, u32, Mhidden> allocator_ids;
+    static inline Alloc_Profile allocators[MAX_ALLOCATORS];
+    static inline u32 allocator_count = 0;
+    static inline Address_Shard addresses[ADDRESS_SHARDS];
     static inline Vec<Function<void()>, Mhidden> finalizers;
 };
 
-RPP_RECORD(Profile::Alloc, RPP_FIELD(name), RPP_FIELD(address), RPP_FIELD(size));
+RPP_RECORD(Profile::Alloc, RPP_FIELD(name), RPP_FIELD(address), RPP_FIELD(size),
+           RPP_FIELD(allocator));
+RPP_RECORD(Profile::Event, RPP_FIELD(time), RPP_FIELD(location), RPP_FIELD(enter));
 
 } // namespace rpp
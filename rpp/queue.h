@@ -18,7 +18,7 @@ struct Queue {
 
     Queue() noexcept = default;
     explicit Queue(u64 capacity) noexcept {
-        data_ = reinterpret_cast<T*>(A::alloc(capacity * sizeof(T)));
+        data_ = reinterpret_cast<T*>(A::alloc(capacity * sizeof(T), alignof(T)));
         length_ = 0;
         last_ = 0;
         capacity_ = capacity;
@@ -69,7 +69,7 @@ struct Queue {
         requires Clone<T> || Copy_Constructable<T>
     {
         Queue<T, B> ret;
-        ret.data_ = reinterpret_cast<T*>(B::alloc(capacity_ * sizeof(T)));
+        ret.data_ = reinterpret_cast<T*>(B::alloc(capacity_ * sizeof(T), alignof(T)));
         ret.length_ = length_;
         ret.last_ = last_;
         ret.capacity_ = capacity_;
@@ -101,7 +101,20 @@ struct Queue {
     void reserve(u64 new_capacity) noexcept {
         if(new_capacity <= capacity_) return;
 
-        T* new_data = reinterpret_cast<T*>(A::alloc(new_capacity * sizeof(T)));
+        if constexpr(Reallocator<A> && Trivially_Movable<T>) {
+            data_ = reinterpret_cast<T*>(A::realloc(data_, capacity_ * sizeof(T),
+                                                    new_capacity * sizeof(T), alignof(T)));
+            if(length_ > last_) {
+                // Move the wrapped front of the queue to the end of the new buffer.
+                u64 first = length_ - last_;
+                Libc::memmove(data_ + new_capacity - first, data_ + capacity_ - first,
+                              sizeof(T) * first);
+            }
+            capacity_ = new_capacity;
+            return;
+        }
+
+        T* new_data = reinterpret_cast<T*>(A::alloc(new_capacity * sizeof(T), alignof(T)));
         T* start = data_ + last_ - length_;
 
         if constexpr(Trivially_Movable<T>) {
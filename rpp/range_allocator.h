@@ -218,7 +218,7 @@ struct Range_Allocator {
 
 private:
     Thread::Mutex mutex;
-    Free_List<Block, A> blocks;
+    Slab_List<Block, A> blocks;
     Array<Block*, Buckets> free_blocks;
     Stats stats;
 
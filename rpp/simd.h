@@ -33,4 +33,18 @@ struct F32x4 {
     [[nodiscard]] static bool cmpeq_all(F32x4 a, F32x4 b) noexcept;
 };
 
+struct U8x16 {
+#ifdef RPP_COMPILER_MSVC
+    alignas(16) u8 data[16];
+#else
+    using u8x16 = u8 __attribute__((ext_vector_type(16)));
+    u8x16 data;
+#endif
+
+    [[nodiscard]] static U8x16 set1(u8 v) noexcept;
+    [[nodiscard]] static U8x16 load(const u8* data) noexcept; // Unaligned
+    // Bit i of the result is set when a[i] == b[i].
+    [[nodiscard]] static u32 cmpeq_mask(U8x16 a, U8x16 b) noexcept;
+};
+
 } // namespace rpp::SIMD
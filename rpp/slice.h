@@ -146,6 +146,14 @@ private:
 template<typename T>
 RPP_TEMPLATE_RECORD(Slice, T, RPP_FIELD(data_), RPP_FIELD(length_));
 
+namespace Hash {
+
+[[nodiscard]] constexpr u64 hash_bytes(Slice<const u8> bytes, u64 seed = 0) noexcept {
+    return hash_bytes(bytes.data(), bytes.length(), seed);
+}
+
+} // namespace Hash
+
 namespace Format {
 
 template<Reflectable T>
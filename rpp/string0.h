@@ -86,7 +86,8 @@ struct String {
 
     String() noexcept = default;
     explicit String(u64 capacity) noexcept
-        : data_(reinterpret_cast<u8*>(A::alloc(capacity))), length_(0), capacity_(capacity) {
+        : data_(reinterpret_cast<u8*>(A::alloc(capacity, alignof(u8)))), length_(0),
+          capacity_(capacity) {
     }
 
     ~String() noexcept {
@@ -119,7 +120,7 @@ struct String {
     template<Allocator B = A>
     [[nodiscard]] String<B> clone() const noexcept {
         String<B> ret;
-        ret.data_ = reinterpret_cast<u8*>(B::alloc(capacity_));
+        ret.data_ = reinterpret_cast<u8*>(B::alloc(capacity_, alignof(u8)));
         ret.length_ = length_;
         ret.capacity_ = capacity_;
         Libc::memcpy(ret.data_, data_, length_);
@@ -189,7 +190,7 @@ private:
 template<Allocator A>
 [[nodiscard]] String<A> String_View::string() const noexcept {
     String<A> ret;
-    ret.data_ = reinterpret_cast<u8*>(A::alloc(length_));
+    ret.data_ = reinterpret_cast<u8*>(A::alloc(length_, alignof(u8)));
     ret.length_ = length_;
     ret.capacity_ = length_;
     Libc::memcpy(ret.data_, data_, length_);
@@ -285,18 +286,14 @@ namespace Hash {
 template<Allocator A>
 struct Hash<String<A>> {
     [[nodiscard]] static u64 hash(const String<A>& string) noexcept {
-        u64 h = 0;
-        for(u8 c : string) h = hash_combine(h, rpp::hash(c));
-        return h;
+        return hash_bytes(string.data(), string.length());
     }
 };
 
 template<>
 struct Hash<String_View> {
     [[nodiscard]] constexpr static u64 hash(const String_View& string) noexcept {
-        u64 h = 0;
-        for(u8 c : string) h = hash_combine(h, rpp::hash(c));
-        return h;
+        return hash_bytes(string.data(), string.length());
     }
 };
 
@@ -0,0 +1,507 @@
+
+#pragma once
+
+#include "base.h"
+#include "simd.h"
+
+namespace rpp {
+
+template<Key K, Move_Constructable V, Allocator A>
+struct Swiss_Map;
+
+template<Key K, Move_Constructable V, Allocator A = Mdefault>
+Swiss_Map(Pair<K, V>...) -> Swiss_Map<K, V, A>;
+
+// Open addressing map that keeps one control byte per slot in a separate array. Lookups
+// compare 16 control bytes at a time against the low 7 bits of the hash, so probes only
+// touch key/value payloads that are likely to match, and misses usually stop at the first
+// group containing an empty slot.
+template<Key K, Move_Constructable V, Allocator A = Mdefault>
+struct Swiss_Map {
+    using Slot = Storage<Pair<K, V>>;
+
+    Swiss_Map() noexcept = default;
+
+    explicit Swiss_Map(u64 capacity) noexcept {
+        allocate(capacity_for(capacity));
+    }
+
+    template<typename... Ss>
+        requires All_Are<Pair<K, V>, Ss...> && Move_Constructable<Pair<K, V>>
+    explicit Swiss_Map(Ss&&... init) noexcept {
+        (insert(rpp::move(init.first), rpp::move(init.second)), ...);
+    }
+
+    Swiss_Map(const Swiss_Map& src) noexcept = delete;
+    Swiss_Map& operator=(const Swiss_Map& src) noexcept = delete;
+
+    Swiss_Map(Swiss_Map&& src) noexcept
+        : ctrl_(src.ctrl_), slots_(src.slots_), capacity_(src.capacity_), length_(src.length_),
+          growth_left_(src.growth_left_) {
+        src.ctrl_ = null;
+        src.slots_ = null;
+        src.capacity_ = 0;
+        src.length_ = 0;
+        src.growth_left_ = 0;
+    }
+    Swiss_Map& operator=(Swiss_Map&& src) noexcept {
+        this->~Swiss_Map();
+        ctrl_ = src.ctrl_;
+        slots_ = src.slots_;
+        capacity_ = src.capacity_;
+        length_ = src.length_;
+        growth_left_ = src.growth_left_;
+        src.ctrl_ = null;
+        src.slots_ = null;
+        src.capacity_ = 0;
+        src.length_ = 0;
+        src.growth_left_ = 0;
+        return *this;
+    }
+
+    ~Swiss_Map() noexcept {
+        destruct_all();
+        A::free(ctrl_);
+        ctrl_ = null;
+        slots_ = null;
+        capacity_ = 0;
+        length_ = 0;
+        growth_left_ = 0;
+    }
+
+    template<Allocator B = A>
+    [[nodiscard]] Swiss_Map<K, V, B> clone() const noexcept
+        requires((Clone<K> || Copy_Constructable<K>) && (Clone<V> || Copy_Constructable<V>))
+    {
+        Swiss_Map<K, V, B> ret;
+        if(capacity_ == 0) return ret;
+        ret.allocate(capacity_);
+        Libc::memcpy(ret.ctrl_, ctrl_, capacity_ + GROUP - 1);
+        for(u64 i = 0; i < capacity_; i++) {
+            if(!is_full(ctrl_[i])) continue;
+            const Pair<K, V>& item = *slots_[i];
+            if constexpr(Clone<K> && Clone<V>) {
+                ret.slots_[i].construct(item.first.clone(), item.second.clone());
+            } else if constexpr(Clone<K> && Copy_Constructable<V>) {
+                ret.slots_[i].construct(item.first.clone(), V{item.second});
+            } else if constexpr(Copy_Constructable<K> && Clone<V>) {
+                ret.slots_[i].construct(K{item.first}, item.second.clone());
+            } else {
+                static_assert(Copy_Constructable<K> && Copy_Constructable<V>);
+                ret.slots_[i].construct(K{item.first}, V{item.second});
+            }
+        }
+        ret.length_ = length_;
+        ret.growth_left_ = growth_left_;
+        return ret;
+    }
+
+    void reserve(u64 new_capacity) noexcept {
+        new_capacity = capacity_for(new_capacity);
+        if(new_capacity <= capacity_) return;
+        rehash(new_capacity);
+    }
+
+    void clear() noexcept {
+        destruct_all();
+        if(ctrl_) {
+            Libc::memset(ctrl_, EMPTY, capacity_ + GROUP - 1);
+            growth_left_ = usable(capacity_);
+        }
+        length_ = 0;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return length_ == 0;
+    }
+    [[nodiscard]] u64 length() const noexcept {
+        return length_;
+    }
+    [[nodiscard]] u64 capacity() const noexcept {
+        return capacity_;
+    }
+
+    V& insert(const K& key, const V& value) noexcept
+        requires Copy_Constructable<K> && Copy_Constructable<V>
+    {
+        return insert(K{key}, V{value});
+    }
+
+    V& insert(K&& key, const V& value) noexcept
+        requires Copy_Constructable<V>
+    {
+        return insert(rpp::move(key), V{value});
+    }
+
+    V& insert(const K& key, V&& value) noexcept
+        requires Copy_Constructable<K>
+    {
+        return insert(K{key}, rpp::move(value));
+    }
+
+    V& insert(K&& key, V&& value) noexcept {
+        u64 hash = rpp::hash(key);
+        if(Opt<u64> idx = find<K>(key, hash); idx.ok()) {
+            slots_[*idx].destruct();
+            slots_[*idx].construct(rpp::move(key), rpp::move(value));
+            return slots_[*idx]->second;
+        }
+        u64 idx = place(hash);
+        slots_[idx].construct(rpp::move(key), rpp::move(value));
+        return slots_[idx]->second;
+    }
+
+    template<typename... Args>
+        requires Constructable<V, Args...>
+    V& emplace(K&& key, Args&&... args) noexcept {
+        return insert(rpp::move(key), V{rpp::forward<Args>(args)...});
+    }
+
+    [[nodiscard]] Opt<Ref<V>> try_get(const K& key) noexcept {
+        if(empty()) return {};
+        if(auto idx = find<K>(key, rpp::hash(key)); idx.ok()) {
+            return Opt{Ref{slots_[*idx]->second}};
+        }
+        return {};
+    }
+
+    [[nodiscard]] Opt<Ref<const V>> try_get(const K& key) const noexcept {
+        if(empty()) return {};
+        if(auto idx = find<K>(key, rpp::hash(key)); idx.ok()) {
+            return Opt{Ref<const V>{slots_[*idx]->second}};
+        }
+        return {};
+    }
+
+    [[nodiscard]] bool try_erase(const K& key) noexcept {
+        if(empty()) return false;
+        Opt<u64> idx = find<K>(key, rpp::hash(key));
+        if(!idx.ok()) return false;
+        slots_[*idx].destruct();
+        // If the slot was never part of a full group, no probe sequence could have passed
+        // through it, so it can become empty instead of a tombstone.
+        u64 before = (*idx - GROUP) & (capacity_ - 1);
+        u32 empty_after = match(U8x16::load(ctrl_ + *idx), EMPTY);
+        u32 empty_before = match(U8x16::load(ctrl_ + before), EMPTY);
+        bool never_full = empty_after && empty_before &&
+                          Math::cttz(empty_after) + Math::ctlz(empty_before << 16) < GROUP;
+        set_ctrl(*idx, never_full ? EMPTY : DELETED);
+        if(never_full) growth_left_++;
+        length_--;
+        return true;
+    }
+
+    [[nodiscard]] bool contains(String_View key) const noexcept
+        requires(Any_String<K>)
+    {
+        if(empty()) return false;
+        return find<String_View>(key, rpp::hash(key)).ok();
+    }
+
+    [[nodiscard]] Opt<Ref<V>> try_get(String_View key) noexcept
+        requires(Any_String<K>)
+    {
+        if(empty()) return {};
+        if(auto idx = find<String_View>(key, rpp::hash(key)); idx.ok()) {
+            return Opt<Ref<V>>{slots_[*idx]->second};
+        }
+        return {};
+    }
+
+    [[nodiscard]] V& get(String_View key) noexcept
+        requires(Any_String<K>)
+    {
+        if(!empty()) {
+            if(auto idx = find<String_View>(key, rpp::hash(key)); idx.ok()) {
+                return slots_[*idx]->second;
+            }
+        }
+        die("Failed to find key %!", key);
+    }
+
+    [[nodiscard]] bool contains(const K& key) const noexcept {
+        return try_get(key).ok();
+    }
+
+    [[nodiscard]] V& get(const K& key) noexcept {
+        Opt<Ref<V>> value = try_get(key);
+        if(!value.ok()) die("Failed to find key %!", key);
+        return **value;
+    }
+
+    [[nodiscard]] const V& get(const K& key) const noexcept {
+        Opt<Ref<const V>> value = try_get(key);
+        if(!value.ok()) die("Failed to find key %!", key);
+        return **value;
+    }
+
+    void erase(const K& key) noexcept {
+        if(!try_erase(key)) die("Failed to erase key %!", key);
+    }
+
+    [[nodiscard]] V& get_or_insert(const K& key) noexcept
+        requires Copy_Constructable<K> && Default_Constructable<V>
+    {
+        Opt<Ref<V>> entry = try_get(key);
+        if(entry.ok()) {
+            return **entry;
+        }
+        return insert(K{key}, V{});
+    }
+
+    [[nodiscard]] V& get_or_insert(K&& key) noexcept
+        requires Default_Constructable<V>
+    {
+        Opt<Ref<V>> entry = try_get(key);
+        if(entry.ok()) {
+            return **entry;
+        }
+        return insert(rpp::move(key), V{});
+    }
+
+    template<bool is_const>
+    struct Iterator {
+        using M = If<is_const, const Swiss_Map, Swiss_Map>;
+
+        Iterator operator++(int) noexcept {
+            Iterator i = *this;
+            count_++;
+            skip();
+            return i;
+        }
+        Iterator operator++() noexcept {
+            count_++;
+            skip();
+            return *this;
+        }
+
+        [[nodiscard]] Pair<const K, V>& operator*() const noexcept
+            requires(!is_const)
+        {
+            return reinterpret_cast<Pair<const K, V>&>(*map_.slots_[count_]);
+        }
+        [[nodiscard]] const Pair<K, V>& operator*() const noexcept {
+            return *map_.slots_[count_];
+        }
+
+        [[nodiscard]] Pair<const K, V>* operator->() const noexcept
+            requires(!is_const)
+        {
+            return reinterpret_cast<Pair<const K, V>*>(&*map_.slots_[count_]);
+        }
+        [[nodiscard]] const Pair<K, V>* operator->() const noexcept {
+            return &*map_.slots_[count_];
+        }
+
+        [[nodiscard]] bool operator==(const Iterator& rhs) const noexcept {
+            return &map_ == &rhs.map_ && count_ == rhs.count_;
+        }
+
+    private:
+        void skip() noexcept {
+            while(count_ < map_.capacity_ && !is_full(map_.ctrl_[count_])) count_++;
+        }
+        Iterator(M& map, u64 count) noexcept : map_(map), count_(count) {
+            skip();
+        }
+        M& map_;
+        u64 count_ = 0;
+
+        friend struct Swiss_Map;
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    [[nodiscard]] const_iterator begin() const noexcept {
+        return const_iterator(*this, 0);
+    }
+    [[nodiscard]] const_iterator end() const noexcept {
+        return const_iterator(*this, capacity_);
+    }
+    [[nodiscard]] iterator begin() noexcept {
+        return iterator(*this, 0);
+    }
+    [[nodiscard]] iterator end() noexcept {
+        return iterator(*this, capacity_);
+    }
+
+private:
+    using U8x16 = SIMD::U8x16;
+
+    // Control bytes are EMPTY, DELETED, or the low 7 bits of the slot's hash. The first
+    // GROUP - 1 control bytes are mirrored after the last one, so a group can be loaded
+    // starting at any slot.
+    constexpr static u64 GROUP = 16;
+    constexpr static u8 EMPTY = 0x80;
+    constexpr static u8 DELETED = 0xfe;
+
+    [[nodiscard]] static bool is_full(u8 ctrl) noexcept {
+        return (ctrl & 0x80) == 0;
+    }
+    [[nodiscard]] static u8 h2(u64 hash) noexcept {
+        return static_cast<u8>(hash & 0x7f);
+    }
+    [[nodiscard]] static u64 h1(u64 hash) noexcept {
+        return hash >> 7;
+    }
+    [[nodiscard]] static u32 match(U8x16 group, u8 ctrl) noexcept {
+        return U8x16::cmpeq_mask(group, U8x16::set1(ctrl));
+    }
+
+    // Tables are at most 7/8 full so every probe sequence reaches an empty slot.
+    [[nodiscard]] static u64 usable(u64 capacity) noexcept {
+        return capacity - capacity / 8;
+    }
+    [[nodiscard]] static u64 capacity_for(u64 length) noexcept {
+        u64 capacity = GROUP;
+        while(usable(capacity) < length) capacity *= 2;
+        return capacity;
+    }
+
+    void allocate(u64 capacity) noexcept {
+        assert(capacity >= GROUP && (capacity & (capacity - 1)) == 0);
+        u64 slots_offset = Math::align_pow2(capacity + GROUP - 1, alignof(Slot));
+        u8* data =
+            reinterpret_cast<u8*>(A::alloc(slots_offset + capacity * sizeof(Slot), alignof(Slot)));
+        Libc::memset(data, EMPTY, capacity + GROUP - 1);
+        ctrl_ = data;
+        slots_ = reinterpret_cast<Slot*>(data + slots_offset);
+        capacity_ = capacity;
+        length_ = 0;
+        growth_left_ = usable(capacity);
+    }
+
+    void destruct_all() noexcept {
+        if constexpr(Must_Destruct<Pair<K, V>>) {
+            for(u64 i = 0; i < capacity_; i++) {
+                if(is_full(ctrl_[i])) slots_[i].destruct();
+            }
+        }
+    }
+
+    void set_ctrl(u64 idx, u8 ctrl) noexcept {
+        ctrl_[idx] = ctrl;
+        if(idx < GROUP - 1) ctrl_[capacity_ + idx] = ctrl;
+    }
+
+    void rehash(u64 new_capacity) noexcept {
+        u8* old_ctrl = ctrl_;
+        Slot* old_slots = slots_;
+        u64 old_capacity = capacity_;
+        u64 old_length = length_;
+
+        allocate(new_capacity);
+        for(u64 i = 0; i < old_capacity; i++) {
+            if(!is_full(old_ctrl[i])) continue;
+            u64 idx = find_free(rpp::hash(old_slots[i]->first));
+            set_ctrl(idx, old_ctrl[i]);
+            slots_[idx].construct(rpp::move(*old_slots[i]));
+            old_slots[i].destruct();
+        }
+        length_ = old_length;
+        growth_left_ -= old_length;
+        A::free(old_ctrl);
+    }
+
+    // Returns the first empty or deleted slot along the probe sequence of hash.
+    [[nodiscard]] u64 find_free(u64 hash) const noexcept {
+        u64 mask = capacity_ - 1;
+        u64 pos = h1(hash) & mask;
+        for(u64 step = GROUP;; step += GROUP) {
+            U8x16 group = U8x16::load(ctrl_ + pos);
+            u32 free = match(group, EMPTY) | match(group, DELETED);
+            if(free) return (pos + Math::cttz(free)) & mask;
+            pos = (pos + step) & mask;
+        }
+    }
+
+    // Claims a slot for a key known not to be in the map.
+    [[nodiscard]] u64 place(u64 hash) noexcept {
+        if(capacity_ == 0) allocate(GROUP);
+        u64 idx = find_free(hash);
+        if(growth_left_ == 0 && ctrl_[idx] == EMPTY) {
+            // Out of empty slots: grow if the map is at least half full, otherwise the
+            // table is mostly tombstones and rehashing in place reclaims them.
+            rehash(length_ >= usable(capacity_) / 2 ? capacity_ * 2 : capacity_);
+            idx = find_free(hash);
+        }
+        if(ctrl_[idx] == EMPTY) growth_left_--;
+        set_ctrl(idx, h2(hash));
+        length_++;
+        return idx;
+    }
+
+    template<Hashable K2>
+    [[nodiscard]] Opt<u64> find(const K2& key, u64 hash) const noexcept {
+        if(capacity_ == 0) return {};
+        u64 mask = capacity_ - 1;
+        u64 pos = h1(hash) & mask;
+        U8x16 tag = U8x16::set1(h2(hash));
+        for(u64 step = GROUP;; step += GROUP) {
+            U8x16 group = U8x16::load(ctrl_ + pos);
+            for(u32 hits = U8x16::cmpeq_mask(group, tag); hits; hits &= hits - 1) {
+                u64 idx = (pos + Math::cttz(hits)) & mask;
+                if(slots_[idx]->first == key) return Opt<u64>{idx};
+            }
+            if(match(group, EMPTY)) return {};
+            pos = (pos + step) & mask;
+        }
+    }
+
+    u8* ctrl_ = null;
+    Slot* slots_ = null;
+    u64 capacity_ = 0;
+    u64 length_ = 0;
+    u64 growth_left_ = 0;
+
+    friend struct Reflect::Refl<Swiss_Map>;
+    template<Key, Move_Constructable, Allocator>
+    friend struct Swiss_Map;
+    template<bool>
+    friend struct Iterator;
+};
+
+template<Key K, Move_Constructable V, Allocator A>
+RPP_TEMPLATE_RECORD(Swiss_Map, RPP_PACK(K, V, A), RPP_FIELD(ctrl_), RPP_FIELD(slots_),
+                    RPP_FIELD(capacity_), RPP_FIELD(length_), RPP_FIELD(growth_left_));
+
+namespace Format {
+
+template<Reflectable K, Reflectable V, Allocator A>
+struct Measure<Swiss_Map<K, V, A>> {
+    [[nodiscard]] static u64 measure(const Swiss_Map<K, V, A>& map) noexcept {
+        u64 n = 0;
+        u64 length = 11;
+        for(const Pair<K, V>& item : map) {
+            length += 5;
+            length += Measure<K>::measure(item.first) + Measure<V>::measure(item.second);
+            if(n + 1 < map.length()) length += 2;
+            n++;
+        }
+        return length;
+    }
+};
+
+template<Allocator O, Reflectable K, Reflectable V, Allocator A>
+struct Write<O, Swiss_Map<K, V, A>> {
+    [[nodiscard]] static u64 write(String<O>& output, u64 idx,
+                                   const Swiss_Map<K, V, A>& map) noexcept {
+        idx = output.write(idx, "Swiss_Map["_v);
+        u64 n = 0;
+        for(const Pair<K, V>& item : map) {
+            idx = output.write(idx, "{"_v);
+            idx = Write<O, K>::write(output, idx, item.first);
+            idx = output.write(idx, " : "_v);
+            idx = Write<O, V>::write(output, idx, item.second);
+            idx = output.write(idx, '}');
+            if(n + 1 < map.length()) idx = output.write(idx, ", "_v);
+            n++;
+        }
+        return output.write(idx, ']');
+    }
+};
+
+} // namespace Format
+
+} // namespace rpp
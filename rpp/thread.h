@@ -95,7 +95,7 @@ struct Thread {
 
     template<Invocable F>
     explicit Thread(F&& f) noexcept {
-        F* data = reinterpret_cast<F*>(A::alloc(sizeof(F)));
+        F* data = reinterpret_cast<F*>(A::alloc(sizeof(F), alignof(F)));
         new(data) F{rpp::forward<F>(f)};
         thread = sys_start(&invoke<F>, data);
     }
@@ -21,6 +21,13 @@ void set_affinity(u64 core) noexcept;
 void sleep(u64 ms) noexcept;
 void pause() noexcept;
 
+// Relaxed accesses for counters that one thread writes and other threads only sample.
+[[nodiscard]] u64 load_relaxed(const u64& value) noexcept;
+void store_relaxed(u64& value, u64 set_to) noexcept;
+// Publishes writes made before the store to threads that load the value.
+[[nodiscard]] u64 load_acquire(const u64& value) noexcept;
+void store_release(u64& value, u64 set_to) noexcept;
+
 [[nodiscard]] u64 perf_counter() noexcept;
 [[nodiscard]] u64 perf_frequency() noexcept;
 [[nodiscard]] u64 hardware_threads() noexcept;
@@ -72,6 +79,75 @@ private:
     friend struct Reflect::Refl<Lock>;
 };
 
+// Held by any number of readers at once, or by a single writer.
+struct Shared_Mutex {
+
+    Shared_Mutex() noexcept;
+    ~Shared_Mutex() noexcept;
+
+    Shared_Mutex(const Shared_Mutex&) noexcept = delete;
+    Shared_Mutex(Shared_Mutex&&) noexcept = delete;
+
+    Shared_Mutex& operator=(Shared_Mutex&&) noexcept = delete;
+    Shared_Mutex& operator=(const Shared_Mutex&) noexcept = delete;
+
+    void lock() noexcept;
+    void unlock() noexcept;
+    void lock_shared() noexcept;
+    void unlock_shared() noexcept;
+
+private:
+#ifdef RPP_OS_WINDOWS
+    void* lock_ = null;
+#else
+    pthread_rwlock_t lock_ = PTHREAD_RWLOCK_INITIALIZER;
+#endif
+
+    friend struct Reflect::Refl<Shared_Mutex>;
+};
+
+struct Shared_Lock {
+
+    Shared_Lock(Shared_Mutex& mutex) noexcept : mutex_(mutex) {
+        mutex_->lock_shared();
+    }
+    ~Shared_Lock() noexcept {
+        if(mutex_.ok()) mutex_->unlock_shared();
+    }
+
+    Shared_Lock(const Shared_Lock&) noexcept = delete;
+    Shared_Lock& operator=(const Shared_Lock&) noexcept = delete;
+
+    Shared_Lock(Shared_Lock&& src) noexcept = default;
+    Shared_Lock& operator=(Shared_Lock&& src) noexcept = default;
+
+private:
+    Ref<Shared_Mutex> mutex_;
+
+    friend struct Reflect::Refl<Shared_Lock>;
+};
+
+struct Exclusive_Lock {
+
+    Exclusive_Lock(Shared_Mutex& mutex) noexcept : mutex_(mutex) {
+        mutex_->lock();
+    }
+    ~Exclusive_Lock() noexcept {
+        if(mutex_.ok()) mutex_->unlock();
+    }
+
+    Exclusive_Lock(const Exclusive_Lock&) noexcept = delete;
+    Exclusive_Lock& operator=(const Exclusive_Lock&) noexcept = delete;
+
+    Exclusive_Lock(Exclusive_Lock&& src) noexcept = default;
+    Exclusive_Lock& operator=(Exclusive_Lock&& src) noexcept = default;
+
+private:
+    Ref<Shared_Mutex> mutex_;
+
+    friend struct Reflect::Refl<Exclusive_Lock>;
+};
+
 struct Atomic {
 
     Atomic() noexcept = default;
@@ -88,6 +164,7 @@ struct Atomic {
     [[nodiscard]] i64 load() const noexcept;
     i64 incr() noexcept;
     i64 decr() noexcept;
+    i64 add(i64 value) noexcept;
     i64 exchange(i64 value) noexcept;
     [[nodiscard]] i64 compare_and_swap(i64 compare_with, i64 set_to) noexcept;
 
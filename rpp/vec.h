@@ -19,7 +19,7 @@ struct Vec {
     Vec() noexcept = default;
 
     explicit Vec(u64 capacity) noexcept
-        : data_(reinterpret_cast<T*>(A::alloc(capacity * sizeof(T)))), length_(0),
+        : data_(reinterpret_cast<T*>(A::alloc(capacity * sizeof(T), alignof(T)))), length_(0),
           capacity_(capacity) {
     }
 
@@ -27,7 +27,7 @@ struct Vec {
         requires Default_Constructable<T>
     {
         Vec ret;
-        ret.data_ = reinterpret_cast<T*>(A::alloc(length * sizeof(T)));
+        ret.data_ = reinterpret_cast<T*>(A::alloc(length * sizeof(T), alignof(T)));
         new(ret.data_) T[length]{};
         ret.capacity_ = length;
         ret.length_ = length;
@@ -117,7 +117,14 @@ struct Vec {
     {
         if(new_capacity <= capacity_) return;
 
-        T* new_data = reinterpret_cast<T*>(A::alloc(new_capacity * sizeof(T)));
+        if constexpr(Reallocator<A> && Trivially_Movable<T>) {
+            data_ = reinterpret_cast<T*>(A::realloc(data_, capacity_ * sizeof(T),
+                                                    new_capacity * sizeof(T), alignof(T)));
+            capacity_ = new_capacity;
+            return;
+        }
+
+        T* new_data = reinterpret_cast<T*>(A::alloc(new_capacity * sizeof(T), alignof(T)));
 
         if(data_ && new_data) {
             if constexpr(Trivially_Movable<T>) {
@@ -273,6 +280,268 @@ template<typename T, Allocator A>
 RPP_TEMPLATE_RECORD(Vec, RPP_PACK(T, A), RPP_FIELD(data_), RPP_FIELD(length_),
                     RPP_FIELD(capacity_));
 
+// Vec that keeps up to N elements inline and only allocates from A once it grows past them.
+template<typename T, u64 N, Allocator A = Mdefault>
+struct Small_Vec {
+    static_assert(N > 0);
+
+    Small_Vec() noexcept : data_(inline_data()), length_(0), capacity_(N) {
+    }
+
+    explicit Small_Vec(u64 capacity) noexcept : Small_Vec() {
+        reserve(capacity);
+    }
+
+    template<typename... Ss>
+        requires All_Are<T, Ss...> && Move_Constructable<T>
+    explicit Small_Vec(Ss&&... init) noexcept : Small_Vec() {
+        reserve(sizeof...(Ss));
+        (push(rpp::move(init)), ...);
+    }
+
+    Small_Vec(const Small_Vec& src) noexcept = delete;
+    Small_Vec& operator=(const Small_Vec& src) noexcept = delete;
+
+    Small_Vec(Small_Vec&& src) noexcept : Small_Vec() {
+        take(src);
+    }
+    Small_Vec& operator=(Small_Vec&& src) noexcept {
+        this->~Small_Vec();
+        take(src);
+        return *this;
+    }
+
+    ~Small_Vec() noexcept {
+        clear();
+        if(spilled()) A::free(data_);
+        data_ = inline_data();
+        capacity_ = N;
+    }
+
+    template<Allocator B = A>
+    [[nodiscard]] Small_Vec<T, N, B> clone() const noexcept
+        requires(Clone<T> || Copy_Constructable<T>)
+    {
+        Small_Vec<T, N, B> ret(length_);
+        for(u64 i = 0; i < length_; i++) {
+            if constexpr(Clone<T>) {
+                ret.push(data_[i].clone());
+            } else {
+                ret.push(T{data_[i]});
+            }
+        }
+        return ret;
+    }
+
+    void grow() noexcept
+        requires Move_Constructable<T>
+    {
+        reserve(2 * capacity_);
+    }
+
+    void clear() noexcept {
+        if constexpr(Must_Destruct<T>) {
+            for(u64 i = 0; i < length_; i++) {
+                data_[i].~T();
+            }
+        }
+        length_ = 0;
+    }
+
+    void reserve(u64 new_capacity) noexcept
+        requires Move_Constructable<T>
+    {
+        if(new_capacity <= capacity_) return;
+
+        if constexpr(Reallocator<A> && Trivially_Movable<T>) {
+            if(spilled()) {
+                data_ = reinterpret_cast<T*>(A::realloc(data_, capacity_ * sizeof(T),
+                                                        new_capacity * sizeof(T), alignof(T)));
+                capacity_ = new_capacity;
+                return;
+            }
+        }
+
+        T* new_data = reinterpret_cast<T*>(A::alloc(new_capacity * sizeof(T), alignof(T)));
+        relocate(new_data, data_, length_);
+        if(spilled()) A::free(data_);
+
+        capacity_ = new_capacity;
+        data_ = new_data;
+    }
+
+    void extend(u64 additional_length) noexcept
+        requires Default_Constructable<T> && Move_Constructable<T>
+    {
+        resize(length_ + additional_length);
+    }
+
+    void resize(u64 new_length) noexcept
+        requires Default_Constructable<T> && Move_Constructable<T>
+    {
+        reserve(new_length);
+        if(new_length > length_) {
+            new(&data_[length_]) T[new_length - length_]{};
+        } else if constexpr(Must_Destruct<T>) {
+            for(u64 i = new_length; i < length_; i++) {
+                data_[i].~T();
+            }
+        }
+        length_ = new_length;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return length_ == 0;
+    }
+    [[nodiscard]] bool full() const noexcept {
+        return length_ == capacity_;
+    }
+    // Whether the elements have moved out of the inline buffer.
+    [[nodiscard]] bool spilled() const noexcept {
+        return capacity_ > N;
+    }
+
+    T& push(const T& value) noexcept
+        requires Copy_Constructable<T>
+    {
+        return push(T{value});
+    }
+
+    T& push(T&& value) noexcept
+        requires Move_Constructable<T>
+    {
+        if(full()) grow();
+        assert(length_ < capacity_);
+        new(&data_[length_]) T{rpp::move(value)};
+        return data_[length_++];
+    }
+
+    template<typename... Args>
+        requires Constructable<T, Args...>
+    T& emplace(Args&&... args) noexcept {
+        if(full()) grow();
+        assert(length_ < capacity_);
+        new(&data_[length_]) T{rpp::forward<Args>(args)...};
+        return data_[length_++];
+    }
+
+    void pop() noexcept {
+        assert(length_ > 0);
+        length_--;
+        if constexpr(Must_Destruct<T>) {
+            data_[length_].~T();
+        }
+    }
+
+    [[nodiscard]] T& front() noexcept {
+        assert(length_ > 0);
+        return data_[0];
+    }
+    [[nodiscard]] const T& front() const noexcept {
+        assert(length_ > 0);
+        return data_[0];
+    }
+
+    [[nodiscard]] T& back() noexcept {
+        assert(length_ > 0);
+        return data_[length_ - 1];
+    }
+    [[nodiscard]] const T& back() const noexcept {
+        assert(length_ > 0);
+        return data_[length_ - 1];
+    }
+
+    [[nodiscard]] T& operator[](u64 idx) noexcept {
+        assert(idx < length_);
+        return data_[idx];
+    }
+    [[nodiscard]] const T& operator[](u64 idx) const noexcept {
+        assert(idx < length_);
+        return data_[idx];
+    }
+
+    [[nodiscard]] const T* begin() const noexcept {
+        return data_;
+    }
+    [[nodiscard]] const T* end() const noexcept {
+        return data_ + length_;
+    }
+    [[nodiscard]] T* begin() noexcept {
+        return data_;
+    }
+    [[nodiscard]] T* end() noexcept {
+        return data_ + length_;
+    }
+
+    [[nodiscard]] u64 length() const noexcept {
+        return length_;
+    }
+    [[nodiscard]] u64 capacity() const noexcept {
+        return capacity_;
+    }
+    [[nodiscard]] u64 bytes() const noexcept {
+        return length_ * sizeof(T);
+    }
+
+    [[nodiscard]] T* data() noexcept {
+        return data_;
+    }
+    [[nodiscard]] const T* data() const noexcept {
+        return data_;
+    }
+
+    [[nodiscard]] Slice<T> slice() noexcept {
+        return Slice{data_, length_};
+    }
+    [[nodiscard]] Slice<const T> slice() const noexcept {
+        return Slice{static_cast<const T*>(data_), length_};
+    }
+
+private:
+    [[nodiscard]] T* inline_data() noexcept {
+        return reinterpret_cast<T*>(inline_);
+    }
+
+    // Moves count elements from src into uninitialized dst and ends their lifetimes in src.
+    static void relocate(T* dst, T* src, u64 count) noexcept {
+        if constexpr(Trivially_Movable<T>) {
+            Libc::memcpy((void*)dst, src, sizeof(T) * count);
+        } else {
+            for(u64 i = 0; i < count; i++) {
+                new(&dst[i]) T{rpp::move(src[i])};
+                if constexpr(Must_Destruct<T>) {
+                    src[i].~T();
+                }
+            }
+        }
+    }
+
+    // Expects this to be empty and inline.
+    void take(Small_Vec& src) noexcept {
+        if(src.spilled()) {
+            data_ = src.data_;
+            capacity_ = src.capacity_;
+            src.data_ = src.inline_data();
+            src.capacity_ = N;
+        } else {
+            relocate(data_, src.data_, src.length_);
+        }
+        length_ = src.length_;
+        src.length_ = 0;
+    }
+
+    T* data_ = null;
+    u64 length_ = 0;
+    u64 capacity_ = 0;
+    alignas(T) u8 inline_[N * sizeof(T)];
+
+    friend struct Reflect::Refl<Small_Vec>;
+};
+
+template<typename T, u64 N, Allocator A>
+RPP_TEMPLATE_RECORD(Small_Vec, RPP_PACK(T, N, A), RPP_FIELD(data_), RPP_FIELD(length_),
+                    RPP_FIELD(capacity_));
+
 namespace Format {
 
 template<Reflectable T, Allocator A>
@@ -299,6 +568,31 @@ struct Write<O, Vec<T, A>> {
     }
 };
 
+template<Reflectable T, u64 N, Allocator A>
+struct Measure<Small_Vec<T, N, A>> {
+    [[nodiscard]] constexpr static u64 measure(const Small_Vec<T, N, A>& vec) noexcept {
+        u64 length = 11;
+        for(u64 i = 0; i < vec.length(); i++) {
+            length += Measure<T>::measure(vec[i]);
+            if(i + 1 < vec.length()) length += 2;
+        }
+        return length;
+    }
+};
+
+template<Allocator O, Reflectable T, u64 N, Allocator A>
+struct Write<O, Small_Vec<T, N, A>> {
+    [[nodiscard]] static u64 write(String<O>& output, u64 idx,
+                                   const Small_Vec<T, N, A>& vec) noexcept {
+        idx = output.write(idx, "Small_Vec["_v);
+        for(u64 i = 0; i < vec.length(); i++) {
+            idx = Write<O, T>::write(output, idx, vec[i]);
+            if(i + 1 < vec.length()) idx = output.write(idx, ", "_v);
+        }
+        return output.write(idx, ']');
+    }
+};
+
 } // namespace Format
 
 } // namespace rpp
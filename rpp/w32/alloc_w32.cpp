@@ -0,0 +1,34 @@
+
+#include "../base.h"
+
+#include <windows.h>
+
+namespace rpp {
+
+[[nodiscard]] void* sys_reserve(u64 size) noexcept {
+    void* ret = VirtualAlloc(null, size, MEM_RESERVE, PAGE_NOACCESS);
+    if(!ret) {
+        die("Failed to reserve % bytes: %", size, Log::sys_error());
+    }
+    return ret;
+}
+
+void sys_commit(void* mem, u64 size) noexcept {
+    if(!VirtualAlloc(mem, size, MEM_COMMIT, PAGE_READWRITE)) {
+        die("Failed to commit % bytes: %", size, Log::sys_error());
+    }
+}
+
+void sys_discard(void* mem, u64 size) noexcept {
+    if(!VirtualAlloc(mem, size, MEM_RESET, PAGE_READWRITE)) {
+        warn("Failed to discard % bytes: %", size, Log::sys_error());
+    }
+}
+
+void sys_release(void* mem, u64) noexcept {
+    if(!VirtualFree(mem, 0, MEM_RELEASE)) {
+        die("Failed to release memory: %", Log::sys_error());
+    }
+}
+
+} // namespace rpp
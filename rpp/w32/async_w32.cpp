@@ -80,4 +80,48 @@ void Event::signal() const noexcept {
     return ret - WAIT_OBJECT_0;
 }
 
+Reactor::Reactor() noexcept {
+}
+
+Reactor::~Reactor() noexcept {
+}
+
+void Reactor::add(const Event& event, u64 id) noexcept {
+    // WaitForMultipleObjects can't wait on more than MAXIMUM_WAIT_OBJECTS handles.
+    assert(handles.length() < MAXIMUM_WAIT_OBJECTS);
+    handles.push(event.event_);
+    ids.push(id);
+}
+
+void Reactor::remove(const Event& event) noexcept {
+    for(u64 i = 0; i < handles.length(); i++) {
+        if(handles[i] == event.event_) {
+            if(i + 1 < handles.length()) {
+                handles[i] = handles.back();
+                ids[i] = ids.back();
+            }
+            handles.pop();
+            ids.pop();
+            return;
+        }
+    }
+    die("Failed to remove event: not registered.");
+}
+
+[[nodiscard]] u64 Reactor::wait(Slice<u64> ready, u64 timeout_ms) noexcept {
+    assert(!ready.empty() && !handles.empty());
+    const HANDLE* wait_handles = reinterpret_cast<const HANDLE*>(handles.data());
+    DWORD timeout = timeout_ms == NO_TIMEOUT
+                        ? INFINITE
+                        : static_cast<DWORD>(Math::min(timeout_ms, static_cast<u64>(INFINITE - 1)));
+    DWORD ret = WaitForMultipleObjectsEx(static_cast<DWORD>(handles.length()), wait_handles, false,
+                                         timeout, false);
+    if(ret == WAIT_TIMEOUT) return 0;
+    if(ret < WAIT_OBJECT_0 || ret >= WAIT_OBJECT_0 + handles.length()) {
+        die("Failed to wait on events: % (%)", static_cast<u32>(ret), Log::sys_error());
+    }
+    ready[0] = ids[ret - WAIT_OBJECT_0];
+    return 1;
+}
+
 } // namespace rpp::Async
@@ -127,26 +127,4 @@ constexpr u64 SECTOR_SIZE = 4096;
     co_return true;
 }
 
-[[nodiscard]] Task<void> wait(Pool<>& pool, u64 ms) noexcept {
-
-    HANDLE timer = CreateWaitableTimer(NULL, TRUE, NULL);
-    if(timer == INVALID_HANDLE_VALUE) {
-        warn("Failed to create waitable timer: %", Log::sys_error());
-        co_return;
-    }
-
-    LARGE_INTEGER liDueTime;
-    liDueTime.QuadPart = -static_cast<LONGLONG>(ms * 10000);
-
-    if(SetWaitableTimer(timer, &liDueTime, 0, NULL, NULL, 0) == FALSE) {
-        warn("Failed to set waitable timer: %", Log::sys_error());
-        CloseHandle(timer);
-        co_return;
-    }
-
-    co_await pool.event(Event::of_sys(timer));
-
-    co_return;
-}
-
 } // namespace rpp::Async
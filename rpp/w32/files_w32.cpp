@@ -99,4 +99,19 @@ namespace rpp::Files {
     return true;
 }
 
+[[nodiscard]] bool remove(String_View path) noexcept {
+
+    auto [ucs2_path, ucs2_path_len] = utf8_to_ucs2(path);
+    if(ucs2_path_len == 0) {
+        warn("Failed to convert file path %!", path);
+        return false;
+    }
+
+    if(DeleteFileW(ucs2_path) == FALSE) {
+        warn("Failed to remove file %: %", path, Log::sys_error());
+        return false;
+    }
+    return true;
+}
+
 } // namespace rpp::Files
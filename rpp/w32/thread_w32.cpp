@@ -22,6 +22,22 @@ void pause() noexcept {
     YieldProcessor();
 }
 
+[[nodiscard]] u64 load_relaxed(const u64& value) noexcept {
+    return static_cast<u64>(ReadNoFence64(reinterpret_cast<const volatile LONG64*>(&value)));
+}
+
+void store_relaxed(u64& value, u64 set_to) noexcept {
+    WriteNoFence64(reinterpret_cast<volatile LONG64*>(&value), static_cast<LONG64>(set_to));
+}
+
+[[nodiscard]] u64 load_acquire(const u64& value) noexcept {
+    return static_cast<u64>(ReadAcquire64(reinterpret_cast<const volatile LONG64*>(&value)));
+}
+
+void store_release(u64& value, u64 set_to) noexcept {
+    WriteRelease64(reinterpret_cast<volatile LONG64*>(&value), static_cast<LONG64>(set_to));
+}
+
 [[nodiscard]] u64 perf_counter() noexcept {
     LARGE_INTEGER li;
     QueryPerformanceCounter(&li);
@@ -117,6 +133,30 @@ void Mutex::unlock() noexcept {
     return TryAcquireSRWLockExclusive(reinterpret_cast<PSRWLOCK>(&lock_));
 }
 
+Shared_Mutex::Shared_Mutex() noexcept {
+    InitializeSRWLock(reinterpret_cast<PSRWLOCK>(&lock_));
+}
+
+Shared_Mutex::~Shared_Mutex() noexcept {
+    lock_ = null;
+}
+
+void Shared_Mutex::lock() noexcept {
+    AcquireSRWLockExclusive(reinterpret_cast<PSRWLOCK>(&lock_));
+}
+
+void Shared_Mutex::unlock() noexcept {
+    ReleaseSRWLockExclusive(reinterpret_cast<PSRWLOCK>(&lock_));
+}
+
+void Shared_Mutex::lock_shared() noexcept {
+    AcquireSRWLockShared(reinterpret_cast<PSRWLOCK>(&lock_));
+}
+
+void Shared_Mutex::unlock_shared() noexcept {
+    ReleaseSRWLockShared(reinterpret_cast<PSRWLOCK>(&lock_));
+}
+
 [[nodiscard]] i64 Atomic::load() const noexcept {
     return value_;
 }
@@ -129,6 +169,10 @@ i64 Atomic::decr() noexcept {
     return InterlockedDecrement64(&value_);
 }
 
+i64 Atomic::add(i64 value) noexcept {
+    return InterlockedAdd64(&value_, value);
+}
+
 i64 Atomic::exchange(i64 value) noexcept {
     return InterlockedExchange64(&value_, value);
 }
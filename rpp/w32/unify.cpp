@@ -1,4 +1,5 @@
 
+#include "alloc_w32.cpp"
 #include "async_w32.cpp"
 #include "asyncio_w32.cpp"
 #include "files_w32.cpp"
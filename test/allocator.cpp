@@ -2,6 +2,7 @@
 #include "test.h"
 
 #include <rpp/rc.h>
+#include <rpp/thread.h>
 
 i32 main() {
     Profile::begin_frame();
@@ -23,6 +24,23 @@ i32 main() {
                 }
             }
         }
+        {
+            Thread::Thread reserved{[]() {
+                Region_Allocator::reserve(Math::GB(1), true);
+                for(u64 i = 0; i < 2; i++) {
+                    Region(R0) {
+                        auto v0 = Vec<u8, Mregion<R0>>::make(Math::MB(2));
+                        Region(R1) {
+                            auto v1 = Vec<u8, Mregion<R1>>::make(Math::MB(4));
+                            v1[Math::MB(4) - 1] = 1;
+                        }
+                        assert(Region_Allocator::size() == Math::MB(2));
+                    }
+                    assert(Region_Allocator::size() == 0);
+                }
+                Region_Allocator::reserve(0);
+            }};
+        }
         Trace("Alloc0") {
             using A = Mallocator<"Test">;
             void* ptr = A::alloc(100);
@@ -54,9 +72,91 @@ i32 main() {
                 Arc<Box<i32, Mpool>, Mpool> pool_arc1{1};
                 Arc<Box<i32, Mpool>, Mpool> pool_arc2{2};
             }
+            {
+                Slab_List<u64, A> slabs;
+                Vec<u64*> nodes;
+                for(u64 i = 0; i < 10000; i++) {
+                    nodes.push(slabs.make(i));
+                }
+                auto stats = slabs.statistics();
+                assert(stats.used == 10000 && stats.capacity >= 10000);
+                assert(stats.slabs < 10000 * sizeof(u64) / Math::KB(4));
+
+                for(u64* node : nodes) {
+                    slabs.destroy(node);
+                }
+                stats = slabs.statistics();
+                assert(stats.used == 0 && stats.slabs == 1);
+            }
+            {
+                struct alignas(64) Line {
+                    u8 data[64];
+                };
+                auto aligned = [](const void* ptr, u64 align) {
+                    return (reinterpret_cast<uptr>(ptr) & (align - 1)) == 0;
+                };
+
+                Vec<Line> lines;
+                lines.push(Line{});
+                assert(aligned(lines.data(), 64));
+
+                Line* line = Mpool::make<Line>();
+                assert(aligned(line, 64));
+                Mpool::destroy(line);
+
+                Region(R) {
+                    u8* byte = reinterpret_cast<u8*>(Mregion<R>::alloc(1, 1));
+                    void* ptr = Mregion<R>::alloc(Math::KB(2), 64);
+                    assert(byte && aligned(ptr, 64));
+                    assert(aligned(Mregion<R>::alloc(8), DEFAULT_ALIGNMENT));
+                }
+                Region(R) {
+                    // The last allocation in a region grows in place.
+                    Vec<u8, Mregion<R>> bytes;
+                    bytes.push(0);
+                    u8* first = bytes.data();
+                    for(u64 i = 1; i < 512; i++) bytes.push(0);
+                    assert(bytes.data() == first);
+                }
+            }
+            {
+                // Frames recycle by size class; larger or overaligned ones use the backing.
+                Vec<u8*> frames;
+                for(u64 size = 1; size <= Math::KB(8); size *= 2) {
+                    u8* frame = reinterpret_cast<u8*>(Mframe::alloc(size));
+                    assert((reinterpret_cast<uptr>(frame) & (DEFAULT_ALIGNMENT - 1)) == 0);
+                    Libc::memset(frame, 0xff, size);
+                    frames.push(frame);
+                }
+                u8* wide = reinterpret_cast<u8*>(Mframe::alloc(64, 256));
+                assert((reinterpret_cast<uptr>(wide) & 255) == 0);
+                frames.push(wide);
+                Thread::Thread freer{[&frames]() {
+                    for(u8* frame : frames) Mframe::free(frame);
+                }};
+            }
+            {
+                // Blocks made on one thread return through another thread's magazine.
+                Vec<i32*> blocks;
+                for(u64 i = 0; i < 1000; i++) {
+                    blocks.push(Mpool::make<i32>(static_cast<i32>(i)));
+                }
+                Thread::Thread freer{[&blocks]() {
+                    for(i32* block : blocks) {
+                        Mpool::destroy(block);
+                    }
+                }};
+            }
         }
     }
     Profile::end_frame();
+    {
+        u64 calls = 0;
+        Profile::iterate_timings([&](Thread::Id, const Profile::Timing_Node& node) {
+            if(node.loc.function == "Alloc0"_v) calls += node.calls;
+        });
+        assert(calls == 1);
+    }
     Profile::finalize();
     return 0;
 }
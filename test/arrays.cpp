@@ -157,6 +157,32 @@ i32 main() {
         static_cast<void>(s3);
         static_cast<void>(s5);
     }
+    Trace("Small_Vec") {
+        Small_Vec<i32, 2> v;
+        v.push(1);
+        v.push(2);
+        assert(!v.spilled() && v.capacity() == 2);
+        v.push(3);
+        assert(v.spilled() && v.length() == 3 && v[2] == 3);
+
+        Small_Vec<i32, 2> v2 = move(v);
+        assert(v.empty() && !v.spilled() && v2.length() == 3);
+
+        Small_Vec<i32, 4> v3{1, 2};
+        Small_Vec<i32, 4> v4 = v3.clone();
+        v3 = move(v4);
+        assert(v3.length() == 2 && !v3.spilled());
+
+        Slice<i32> sl = v2.slice();
+        assert(sl.length() == 3 && sl[0] == 1);
+        assert(format<Mhidden>("%"_v, v3).view() == "Small_Vec[1, 2]"_v);
+
+        Small_Vec<String<>, 1> sv;
+        sv.push("Hello"_v.string());
+        sv.push("World"_v.string());
+        Small_Vec<String<>, 1> sv2 = move(sv);
+        assert(sv2.length() == 2 && sv2[1].view() == "World"_v);
+    }
     Trace("Stack") {
         auto deduct = Stack{1, 2, 3};
         static_assert(Same<decltype(deduct), Stack<i32>>);
@@ -267,6 +293,19 @@ i32 main() {
 
         assert(sv3.length() == 2);
 
+        {
+            // Growing a wrapped queue keeps its order.
+            Queue<i32> wrapped;
+            for(i32 i = 0; i < 8; i++) wrapped.push(i);
+            for(i32 i = 0; i < 5; i++) wrapped.pop();
+            for(i32 i = 8; i < 20; i++) wrapped.push(i);
+            for(i32 i = 5; i < 20; i++) {
+                assert(wrapped.front() == i);
+                wrapped.pop();
+            }
+            assert(wrapped.empty());
+        }
+
         Queue<Function<void()>> vf;
         for(i32 i = 0; i < 10; i++) {
             vf.push([]() { info("Hello"); });
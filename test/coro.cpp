@@ -99,6 +99,17 @@ i32 main() {
             assert(task.done());
             assert(task.block() == 1);
         }
+        {
+            auto co = [](i32 i) -> Async::Task<i32, Mframe> {
+                co_await Async::Suspend{};
+                co_return i;
+            };
+            for(i32 i = 0; i < 1000; i++) {
+                Async::Task<i32, Mframe> task = co(i);
+                task.resume();
+                assert(task.block() == i);
+            }
+        }
     }
     return 0;
 }
@@ -0,0 +1,31 @@
+
+#include "test.h"
+
+i32 main() {
+    Test test{"log"_v};
+    Trace("Async") {
+        Log::start_async();
+        for(i32 i = 0; i < 4; i++) {
+            info("async %", i);
+        }
+        info("deferred % % % %", 1.5f, true, Log::Level::warn, Array<u8, 2>{1, 2});
+        Region(R) {
+            String<Mregion<R>> text{200};
+            text.set_length(200);
+            for(u8& c : text) c = 'x';
+            info("%", text.view());
+        }
+        Log::flush();
+        Log::stop_async();
+    }
+    Trace("Backpressure") {
+        Log::start_async(2, Log::Overflow::block);
+        for(i32 i = 0; i < 8; i++) {
+            info("queued %", i);
+        }
+        assert(Log::dropped() == 0);
+        Log::stop_async();
+    }
+    info("sync");
+    return 0;
+}
@@ -1,6 +1,10 @@
 
 #include "test.h"
 
+#include <rpp/concurrent_map.h>
+#include <rpp/swiss_map.h>
+#include <rpp/thread.h>
+
 i32 main() {
     Test test{"map"_v};
     Trace("Map") {
@@ -72,5 +76,97 @@ i32 main() {
             ff.insert(i, []() { info("Hello"); });
         }
     }
+    Trace("Swiss_Map") {
+        auto deduct = Swiss_Map{Pair{"foo"_v, 0}, Pair{"bar"_v, 1}};
+        static_assert(Same<decltype(deduct), Swiss_Map<String_View, i32>>);
+
+        {
+            Swiss_Map<String<>, i32> strings{Pair{"Hello"_v.string(), 1}};
+            assert(strings.contains("Hello"_v));
+            assert(strings.get("Hello"_v) == 1);
+            assert(!strings.try_get("World"_v).ok());
+        }
+
+        Swiss_Map<i32, i32> v;
+        for(i32 i = 0; i < 1000; i++) {
+            v.insert(i, i * 2);
+        }
+        assert(v.length() == 1000);
+        for(i32 i = 0; i < 1000; i += 2) {
+            v.erase(i);
+        }
+        assert(v.length() == 500);
+        for(i32 i = 0; i < 1000; i++) {
+            assert(v.contains(i) == (i % 2 == 1));
+        }
+
+        i32 sum = 0;
+        for(auto& [k, vv] : v) {
+            assert(vv == k * 2);
+            sum += k;
+        }
+        assert(sum == 250000);
+
+        // Churn leaves tombstones that must be reclaimed instead of growing forever.
+        u64 capacity = v.capacity();
+        for(i32 i = 1000; i < 100000; i++) {
+            v.insert(i, i);
+            v.erase(i);
+        }
+        assert(v.capacity() == capacity && v.length() == 500);
+
+        Swiss_Map<i32, i32> v2 = v.clone();
+        Swiss_Map<i32, i32> v3 = move(v2);
+        assert(v3.length() == 500 && v3.get(999) == 1998);
+
+        Swiss_Map<i32, Function<void()>> ff;
+        for(i32 i = 0; i < 40; i++) {
+            ff.insert(i, []() { info("Hello"); });
+        }
+    }
+    Trace("Concurrent_Map") {
+        Concurrent_Map<i32, i32> m;
+        m.insert(1, 2);
+        assert(m.contains(1) && !m.contains(2));
+        assert(*m.try_get(1) == 2 && !m.try_get(2).ok());
+        assert(m.update(1, [](i32& v) { v = 3; }));
+        assert(m.read(1, [](const i32& v) { assert(v == 3); }));
+        assert(m.get_or_insert(1, [] { return 4; }) == 3);
+        assert(m.get_or_insert(2) == 0);
+        m.erase(2);
+        assert(!m.try_erase(2) && m.length() == 1);
+
+        // Threads race to fill the same keys; each key is made exactly once.
+        Thread::Atomic made;
+        {
+            Vec<Thread::Thread<>> threads;
+            for(i32 t = 0; t < 4; t++) {
+                threads.push(Thread::Thread{[&m, &made, t]() {
+                    for(i32 i = 0; i < 1000; i++) {
+                        i32 v = m.get_or_insert(i, [&made, i]() {
+                            made.incr();
+                            return i * 2;
+                        });
+                        assert(v == i * 2 || (i == 1 && v == 3));
+                        if(i % 4 == t) m.insert(i + 1000, i);
+                    }
+                }});
+            }
+        }
+        assert(made.load() == 999);
+        assert(m.length() == 2000);
+
+        i64 sum = 0;
+        m.for_each([&sum](const i32& k, const i32& v) {
+            if(k >= 1000) sum += v;
+        });
+        assert(sum == 499500);
+
+        auto entries = m.snapshot();
+        assert(entries.length() == 2000);
+
+        m.clear();
+        assert(m.empty());
+    }
     return 0;
 }
@@ -2,6 +2,7 @@
 #include "test.h"
 
 #include <rpp/asyncio.h>
+#include <rpp/parallel.h>
 #include <rpp/pool.h>
 
 auto lots_of_jobs(Async::Pool<>& pool, u64 depth) -> Async::Task<u64> {
@@ -14,6 +15,68 @@ auto lots_of_jobs(Async::Pool<>& pool, u64 depth) -> Async::Task<u64> {
     co_return co_await job0 + co_await job1;
 };
 
+auto cancel_timer(Async::Pool<>& pool, Async::Timer_Handle<> timer) -> Async::Task<void> {
+    co_await pool.suspend();
+    assert(timer.cancel());
+}
+
+auto fan_in(Async::Pool<>& pool, u64 n) -> Async::Task<u64> {
+    auto leaf = [](Async::Pool<>& pool, u64 i) -> Async::Task<u64> {
+        co_await pool.suspend();
+        co_return i;
+    };
+    Vec<Async::Task<u64>> tasks;
+    for(u64 i = 0; i < n; i++) tasks.push(leaf(pool, i));
+    co_await Async::when_all(tasks.slice());
+
+    u64 sum = 0;
+    for(auto& task : tasks) sum += co_await task;
+
+    auto first = leaf(pool, 1);
+    auto second = leaf(pool, 2);
+    u64 index = co_await Async::when_any(first, second);
+    assert(index < 2);
+    co_await Async::when_all(first, second);
+    co_return sum + co_await first + co_await second;
+}
+
+// The timeout never completes on its own, so when_any must not wait for it.
+auto work_or_timeout(Async::Pool<>& pool, u64 i) -> Async::Task<u64> {
+    auto timer = pool.timer(60000);
+    Async::Timer_Handle<> handle = timer.handle();
+    auto wait = [](Async::Schedule_Timer<>& timer) -> Async::Task<bool> {
+        co_return co_await timer;
+    };
+    auto work = [](Async::Pool<>& pool, u64 i) -> Async::Task<u64> {
+        co_await pool.suspend();
+        co_return i;
+    };
+    auto timeout = wait(timer);
+    auto result = work(pool, i);
+    u64 index = co_await Async::when_any(result, timeout);
+    assert(index == 0);
+
+    assert(handle.cancel());
+    assert(!co_await timeout);
+    co_return co_await result;
+}
+
+auto canceled_wait(Async::Pool<>& pool) -> Async::Task<bool> {
+    auto timer = pool.timer(60000);
+    auto cancel = cancel_timer(pool, timer.handle());
+    bool elapsed = co_await timer;
+    co_await cancel;
+    co_return elapsed;
+}
+
+auto canceled_early(Async::Pool<>& pool) -> Async::Task<bool> {
+    auto timer = pool.timer(60000);
+    Async::Timer_Handle<> handle = timer.handle();
+    assert(handle.cancel());
+    assert(!handle.cancel());
+    co_return co_await timer;
+}
+
 i32 main() {
     Test test{"pool"_v};
     {
@@ -140,6 +203,116 @@ i32 main() {
             job().block();
             info("Waited 100ms.");
         }
+        {
+            for(u64 i = 0; i < 100; i++) {
+                assert(!canceled_wait(pool).block());
+                assert(!canceled_early(pool).block());
+            }
+
+            // Destroying armed timers, as when a suspended frame is destroyed, leaves stale heap
+            // entries that must be skipped once they expire.
+            for(u64 i = 0; i < 100; i++) {
+                auto timer = pool.timer(1);
+                if(i % 2) static_cast<void>(timer.handle());
+                static_cast<void>(timer.await_suspend(std::noop_coroutine()));
+            }
+            Async::wait(pool, 10).block();
+            for(u64 i = 0; i < 100; i++) {
+                assert(!canceled_wait(pool).block());
+            }
+        }
+        {
+            for(u64 i = 0; i < 100; i++) {
+                assert(fan_in(pool, i).block() == i * (i - 1) / 2 + 3);
+            }
+            for(u64 i = 0; i < 1000; i++) {
+                assert(work_or_timeout(pool, i).block() == i);
+            }
+        }
+    }
+    {
+        Async::Pool pool;
+
+        Vec<u64> values;
+        for(u64 i = 0; i < 10000; i++) values.push((i * 7919) % 10007);
+
+        Async::parallel_for(pool, values.slice(), [](u64& value) { value += 1; }, 100);
+        u64 sum = Async::parallel_reduce(
+            pool, values.slice(), u64{0}, [](u64 acc, const u64& value) { return acc + value; },
+            [](u64 l, u64 r) { return l + r; }, 100);
+        u64 expected = 0;
+        for(u64 value : values) expected += value;
+        assert(sum == expected);
+
+        Async::parallel_sort(pool, values.slice(), 100);
+        for(u64 i = 1; i < values.length(); i++) assert(values[i - 1] <= values[i]);
+
+        Async::parallel_sort(
+            pool, values.slice(), [](const u64& l, const u64& r) { return l > r; }, 100);
+        for(u64 i = 1; i < values.length(); i++) assert(values[i - 1] >= values[i]);
+
+        Vec<u64> ones;
+        for(u64 i = 0; i < 5000; i++) ones.push(1);
+        Async::parallel_scan(
+            pool, ones.slice(), u64{0}, [](u64 l, const u64& r) { return l + r; }, 64);
+        for(u64 i = 0; i < ones.length(); i++) assert(ones[i] == i + 1);
+
+        Async::parallel_for(pool, u64{0}, [](u64, u64) { assert(false); });
+    }
+    {
+        Async::Pool pool;
+
+        auto job = [](Async::Pool<>& pool, Thread::Priority priority) -> Async::Task<u64> {
+            co_await pool.suspend(priority);
+            co_return static_cast<u64>(priority);
+        };
+
+        Vec<Async::Task<u64>> tasks;
+        for(u64 i = 0; i < 400; i++) {
+            tasks.push(job(pool, static_cast<Thread::Priority>(i % Async::Pool<>::PRIORITIES)));
+        }
+        u64 sum = 0;
+        for(auto& task : tasks) sum += task.block();
+        assert(sum == 600);
+
+        auto stats = pool.statistics();
+        for(u64 lane = 0; lane < Async::Pool<>::PRIORITIES; lane++) {
+            assert(stats.executed[lane] == 100 && stats.aged[lane] <= 100);
+        }
+    }
+    {
+        Async::Pool pool;
+
+        // Critical jobs keep requeueing themselves until the low priority job has run.
+        Thread::Atomic stop, served;
+        auto spin = [](Async::Pool<>& pool, Thread::Atomic& stop,
+                       Thread::Atomic& served) -> Async::Task<void> {
+            while(stop.load() == 0) {
+                co_await pool.suspend(Thread::Priority::critical);
+                served.incr();
+            }
+        };
+        auto starved = [](Async::Pool<>& pool, Thread::Atomic& stop,
+                          Thread::Atomic& served) -> Async::Task<u64> {
+            i64 before = served.load();
+            co_await pool.suspend(Thread::Priority::low);
+            u64 passed = static_cast<u64>(served.load() - before);
+            stop.exchange(1);
+            co_return passed;
+        };
+
+        Vec<Async::Task<void>> spinners;
+        for(u64 i = 0; i < 2 * (pool.n_threads() + 1); i++) {
+            spinners.push(spin(pool, stop, served));
+        }
+        u64 passed = starved(pool, stop, served).block();
+        for(auto& spinner : spinners) spinner.block();
+
+        // Each worker serves at most AGING_LIMIT critical jobs before trying the low lane. A
+        // try can miss the job while another worker holds it, so allow a few rounds.
+        u64 round = (Async::Pool<>::AGING_LIMIT + 1) * pool.n_threads();
+        assert(passed <= 4 * round);
+        assert(pool.statistics().executed[static_cast<u64>(Thread::Priority::low)] == 1);
     }
     return 0;
 }
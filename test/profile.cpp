@@ -0,0 +1,62 @@
+
+#include "test.h"
+
+#include <rpp/thread.h>
+
+[[nodiscard]] bool has_substring(String_View text, String_View pattern) noexcept {
+    for(u64 i = 0; i + pattern.length() <= text.length(); i++) {
+        if(text.sub(i, i + pattern.length()) == pattern) return true;
+    }
+    return false;
+}
+
+i32 main() {
+    String_View path = "profile.json"_v;
+    assert(Profile::start_trace(path));
+
+    Profile::begin_frame();
+    {
+        // Scope names built at runtime are copied, so reusing the buffer keeps them distinct.
+        char name[] = "Runtime0";
+        for(u64 i = 0; i < 4; i++) {
+            name[7] = static_cast<char>('0' + i % 2);
+            Trace(String_View{name}) {
+            }
+        }
+        name[7] = 'X';
+    }
+    Profile::end_frame();
+    {
+        u64 runtime0 = 0, runtime1 = 0;
+        Profile::iterate_timings([&](Thread::Id, const Profile::Timing_Node& node) {
+            if(node.loc.function == "Runtime0"_v) runtime0 += node.calls;
+            if(node.loc.function == "Runtime1"_v) runtime1 += node.calls;
+        });
+        assert(runtime0 == 2 && runtime1 == 2);
+    }
+    {
+        // A worker outside of a frame only replays its events when it exits, so stopping the
+        // trace must write them out.
+        Thread::Atomic entered, stopped;
+        Thread::Thread worker{[&]() {
+            Trace("Worker") {
+            }
+            entered.exchange(1);
+            while(stopped.load() == 0) Thread::pause();
+        }};
+        while(entered.load() == 0) Thread::pause();
+        Profile::stop_trace();
+        stopped.exchange(1);
+    }
+    {
+        auto trace = Files::read(path);
+        assert(trace.ok());
+        String_View text{trace->data(), trace->length()};
+        assert(text.length() > 4 && text[0] == '[' && text[text.length() - 2] == ']');
+        assert(has_substring(text, "\"name\":\"Runtime1\""_v));
+        assert(has_substring(text, "\"name\":\"Worker\""_v));
+        assert(Files::remove(path));
+    }
+    Profile::finalize();
+    return 0;
+}
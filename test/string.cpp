@@ -29,6 +29,23 @@ i32 main() {
         (void)s4;
         (void)sv4;
     }
+    Trace("Hash") {
+        String_View path = "assets/textures/terrain/grass_albedo.png"_v;
+        String owned = path.string();
+        assert(hash(path) == hash(owned));
+        assert(hash(path) == Hash::hash_bytes(Slice<const u8>{path.data(), path.length()}));
+        assert(hash("grass"_v) != hash("Grass"_v));
+
+        static_assert(hash_literal("grass") != hash_literal("grasS"));
+        static_assert(hash_literal("x", 1) != hash_literal("x", 2));
+
+        struct Cell {
+            i32 x, y;
+        };
+        static_assert(!Hashable<Cell>);
+        static_assert(Hashable<Pair<i32, i32>>);
+        assert(hash(Pair<i32, i32>{1, 2}) != hash(Pair<i32, i32>{2, 1}));
+    }
 
     return 0;
 }